@@ -13,3 +13,5 @@ do
   ./build/perf-suite --benchmark_filter="BM_select.*/$i$"
   ./build/perf-suite --benchmark_filter="BM_successor.*/$i$"
 done
+
+./build/perf-suite --benchmark_filter="BM_word_decode.*"
@@ -0,0 +1,141 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <vector>
+#include <sdsl/int_vector.hpp>
+#include "s18_vector.hpp"
+
+#define LISTS 1000
+
+static double const DENSITY[4] = {.001, .01, .1, .5};
+
+/* Small posting lists as bit vectors, of random lengths and density d */
+std::vector<sdsl::bit_vector> const &test_lists(int64_t d)
+{
+	static std::vector<sdsl::bit_vector> lists[4];
+	if (lists[d].size())
+		return lists[d];
+
+	std::mt19937 g(static_cast<uint32_t>(d));
+	std::uniform_int_distribution<uint64_t> len(1000, 100000);
+	std::bernoulli_distribution one(DENSITY[d]);
+	for (uint64_t i = 0; i < LISTS; i++) {
+		sdsl::bit_vector bv(len(g), 0);
+		for (uint64_t j = 0; j < bv.size(); j++)
+			bv[j] = one(g);
+		lists[d].push_back(bv);
+	}
+
+	return lists[d];
+}
+
+static int64_t total_ones(std::vector<sdsl::bit_vector> const &lists)
+{
+	int64_t ones = 0;
+	for (sdsl::bit_vector const &bv : lists)
+		ones += static_cast<int64_t>(sdsl::util::cnt_one_bits(bv));
+	return ones;
+}
+
+/*
+ * CONSTRUCTION
+ */
+static void BM_construct_bv(benchmark::State& state) {
+	std::vector<sdsl::bit_vector> const &lists = test_lists(state.range(0));
+
+	for (auto _ : state) {
+		for (sdsl::bit_vector const &bv : lists) {
+			sdsl::s18::vector<> s18(bv);
+			benchmark::DoNotOptimize(s18.data().data());
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * total_ones(lists));
+}
+BENCHMARK(BM_construct_bv)->DenseRange(0,3,1);
+
+static void BM_construct_builder(benchmark::State& state) {
+	std::vector<sdsl::bit_vector> const &lists = test_lists(state.range(0));
+	std::vector<std::vector<uint64_t>> positions;
+	for (sdsl::bit_vector const &bv : lists) {
+		positions.emplace_back();
+		for (uint64_t i = 0; i < bv.size(); i++)
+			if (bv[i]) positions.back().push_back(i);
+	}
+
+	for (auto _ : state) {
+		for (uint64_t i = 0; i < lists.size(); i++) {
+			sdsl::s18::builder<> b(lists[i].size());
+			b.append(positions[i].begin(), positions[i].end());
+			sdsl::s18::vector<> s18 = b.build();
+			benchmark::DoNotOptimize(s18.data().data());
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * total_ones(lists));
+}
+BENCHMARK(BM_construct_builder)->DenseRange(0,3,1);
+
+/* One large vector built with every hardware thread */
+static void BM_construct_parallel(benchmark::State& state) {
+	std::mt19937 g(0);
+	std::bernoulli_distribution one(DENSITY[state.range(0)]);
+	sdsl::bit_vector bv(uint64_t(1) << 26, 0);
+	for (uint64_t i = 0; i < bv.size(); i++)
+		bv[i] = one(g);
+	uint64_t const threads = std::max<uint64_t>(std::thread::hardware_concurrency(), 1);
+
+	for (auto _ : state) {
+		sdsl::s18::vector<> s18(bv, threads);
+		benchmark::DoNotOptimize(s18.data().data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sdsl::util::cnt_one_bits(bv)));
+	state.counters["threads"] = static_cast<double>(threads);
+}
+BENCHMARK(BM_construct_parallel)->DenseRange(0,3,1)->Unit(benchmark::kMillisecond);
+
+/*
+ * LOADING
+ */
+#define LOAD_FILE "construction.s18"
+
+/* One large vector written to LOAD_FILE, reopened by every iteration */
+static void write_load_file(int64_t d)
+{
+	std::mt19937 g(0);
+	std::bernoulli_distribution one(DENSITY[d]);
+	sdsl::bit_vector bv(uint64_t(1) << 28, 0);
+	for (uint64_t i = 0; i < bv.size(); i++)
+		bv[i] = one(g);
+	std::ofstream out(LOAD_FILE, std::ios::binary);
+	sdsl::s18::vector<>(bv).serialize(out);
+}
+
+static void BM_load_s18(benchmark::State& state) {
+	write_load_file(state.range(0));
+
+	for (auto _ : state) {
+		sdsl::s18::vector<> s18(LOAD_FILE);
+		benchmark::DoNotOptimize(s18.data().data());
+	}
+
+	std::remove(LOAD_FILE);
+}
+BENCHMARK(BM_load_s18)->DenseRange(0,3,1)->Unit(benchmark::kMillisecond);
+
+/* Mapping the file, then one rank so the first pages are touched */
+static void BM_map_s18(benchmark::State& state) {
+	write_load_file(state.range(0));
+
+	for (auto _ : state) {
+		sdsl::s18::mapped_vector<> s18(LOAD_FILE);
+		sdsl::s18::rank_support<1, 256, sdsl::s18::mapped_words> rs(s18);
+		benchmark::DoNotOptimize(rs(s18.size() / 2));
+	}
+
+	std::remove(LOAD_FILE);
+}
+BENCHMARK(BM_map_s18)->DenseRange(0,3,1)->Unit(benchmark::kMillisecond);
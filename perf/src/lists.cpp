@@ -0,0 +1,149 @@
+#include <benchmark/benchmark.h>
+#include <iterator>
+#include <random>
+#include <vector>
+#include <sdsl/int_vector.hpp>
+#include "s18_vector.hpp"
+
+#define LIST_SIZE (uint64_t(1) << 26)
+
+/* Long list at density .3, short lists 1 to 10000 times sparser */
+static int64_t const RATIO[5] = {1, 10, 100, 1000, 10000};
+
+static sdsl::bit_vector random_list(double p, uint32_t seed)
+{
+	std::mt19937 g(seed);
+	std::bernoulli_distribution one(p);
+	sdsl::bit_vector bv(LIST_SIZE, 0);
+	for (uint64_t i = 0; i < bv.size(); i++)
+		bv[i] = one(g);
+	return bv;
+}
+
+sdsl::bit_vector const &long_list(void)
+{
+	static sdsl::bit_vector bv = random_list(.3, 0);
+	return bv;
+}
+
+sdsl::bit_vector const &short_list(int64_t r)
+{
+	static sdsl::bit_vector lists[5];
+	if (lists[r].size() == 0)
+		lists[r] = random_list(.3 / static_cast<double>(RATIO[r]), static_cast<uint32_t>(r + 1));
+	return lists[r];
+}
+
+/*
+ * INTERSECTION
+ */
+template <class S18V>
+static void BM_intersect_s18(benchmark::State& state) {
+	S18V a(short_list(state.range(0)));
+	S18V b(long_list());
+	std::vector<uint64_t> out;
+	out.reserve(a.ones());
+
+	for (auto _ : state) {
+		out.clear();
+		sdsl::s18::intersect(a, b, std::back_inserter(out));
+		benchmark::DoNotOptimize(out.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(a.ones()));
+	state.counters["ratio"] = static_cast<double>(RATIO[state.range(0)]);
+}
+BENCHMARK_TEMPLATE(BM_intersect_s18, sdsl::s18::vector<64>)->DenseRange(0,4,1)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_intersect_s18, sdsl::s18::vector<256>)->DenseRange(0,4,1)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_intersect_s18, sdsl::s18::vector<64, sdsl::int_vector<32>, sdsl::s18::byte_summary>)->DenseRange(0,4,1)->Unit(benchmark::kMillisecond);
+
+template <class S18V>
+static void BM_intersect_count_s18(benchmark::State& state) {
+	S18V a(short_list(state.range(0)));
+	S18V b(long_list());
+
+	for (auto _ : state)
+		benchmark::DoNotOptimize(sdsl::s18::intersect_count(a, b));
+
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(a.ones()));
+	state.counters["ratio"] = static_cast<double>(RATIO[state.range(0)]);
+}
+BENCHMARK_TEMPLATE(BM_intersect_count_s18, sdsl::s18::vector<64>)->DenseRange(0,4,1)->Unit(benchmark::kMillisecond);
+
+/* Both lists walked in full, the baseline skipping has to beat */
+template <class S18V>
+static void BM_intersect_merge_s18(benchmark::State& state) {
+	S18V a(short_list(state.range(0)));
+	S18V b(long_list());
+
+	for (auto _ : state) {
+		uint64_t count = 0;
+		auto x = a.begin_ones();
+		auto y = b.begin_ones();
+		while (x != a.end_ones() and y != b.end_ones()) {
+			if (*x < *y) ++x;
+			else if (*y < *x) ++y;
+			else { count++; ++x; ++y; }
+		}
+		benchmark::DoNotOptimize(count);
+	}
+
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(a.ones()));
+	state.counters["ratio"] = static_cast<double>(RATIO[state.range(0)]);
+}
+BENCHMARK_TEMPLATE(BM_intersect_merge_s18, sdsl::s18::vector<64>)->DenseRange(0,4,1)->Unit(benchmark::kMillisecond);
+
+/*
+ * UNION
+ */
+/* k lists of the same size, each 1000 times sparser than the long list */
+template <class S18V>
+static std::vector<S18V> const &union_lists(int64_t k)
+{
+	static std::vector<S18V> lists;
+	while (lists.size() < static_cast<uint64_t>(k))
+		lists.emplace_back(random_list(.0003, static_cast<uint32_t>(100 + lists.size())));
+	return lists;
+}
+
+template <class S18V>
+static void BM_union_s18(benchmark::State& state) {
+	std::vector<S18V> const &lists = union_lists<S18V>(state.range(0));
+	std::vector<S18V const *> inputs;
+	int64_t ones = 0;
+	for (int64_t i = 0; i < state.range(0); i++) {
+		inputs.push_back(&lists[static_cast<uint64_t>(i)]);
+		ones += static_cast<int64_t>(lists[static_cast<uint64_t>(i)].ones());
+	}
+
+	for (auto _ : state) {
+		S18V s18 = sdsl::s18::unite(inputs);
+		benchmark::DoNotOptimize(s18.data().data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * ones);
+}
+BENCHMARK_TEMPLATE(BM_union_s18, sdsl::s18::vector<64>)->Arg(2)->Arg(8)->Arg(32)->Arg(128)->Unit(benchmark::kMillisecond);
+
+/* Decompressing every input into a bit vector and compressing it again */
+template <class S18V>
+static void BM_union_bv(benchmark::State& state) {
+	std::vector<S18V> const &lists = union_lists<S18V>(state.range(0));
+	int64_t ones = 0;
+	for (int64_t i = 0; i < state.range(0); i++)
+		ones += static_cast<int64_t>(lists[static_cast<uint64_t>(i)].ones());
+
+	for (auto _ : state) {
+		sdsl::bit_vector bv(LIST_SIZE, 0);
+		for (int64_t i = 0; i < state.range(0); i++) {
+			S18V const &list = lists[static_cast<uint64_t>(i)];
+			for (auto one = list.begin_ones(); one != list.end_ones(); ++one)
+				bv[*one] = 1;
+		}
+		S18V s18(bv);
+		benchmark::DoNotOptimize(s18.data().data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * ones);
+}
+BENCHMARK_TEMPLATE(BM_union_bv, sdsl::s18::vector<64>)->Arg(2)->Arg(8)->Arg(32)->Arg(128)->Unit(benchmark::kMillisecond);
@@ -3,6 +3,7 @@
 #include <sdsl/rrr_vector.hpp>
 #include <sdsl/sd_vector.hpp>
 #include <sdsl/hyb_vector.hpp>
+#include <sdsl/memory_management.hpp>
 #include <sdsl/util.hpp>
 #include "s18_vector.hpp"
 #include "s9_vector.hpp"
@@ -32,6 +33,34 @@ void create_bv(sdsl::bit_vector &bv, unsigned int lambda, unsigned int x, double
 	bv.resize(pos);
 }
 
+/* Report the peak memory allocated while alive as the `peak` counter, in MB */
+class peak_monitor
+{
+	private:
+		benchmark::State &state;
+	public:
+		peak_monitor(benchmark::State &s)
+			: state(s)
+		{
+			sdsl::memory_monitor::start();
+		}
+		~peak_monitor()
+		{
+			sdsl::memory_monitor::stop();
+			state.counters["peak"] = static_cast<double>(sdsl::memory_monitor::peak()) / (1 << 20);
+		}
+		peak_monitor(peak_monitor const &) = delete;
+		peak_monitor &operator=(peak_monitor const &) = delete;
+};
+
+/* Construct a T from bv, measuring its peak construction memory */
+template <class T>
+static T monitored(sdsl::bit_vector const &bv, benchmark::State &state)
+{
+	peak_monitor m(state);
+	return T(bv);
+}
+
 sdsl::bit_vector &test_bv(int c)
 {
 	static int const lambda[] = {4, 7, 31, 127};
@@ -114,7 +143,7 @@ template <class S9V>
 static void BM_access_s9(benchmark::State& state) {
 	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
 
-	S9V s9(bv);
+	S9V s9 = monitored<S9V>(bv, state);
 	std::random_device g;
 	std::uniform_int_distribution<int> idx(0, SIZE[state.range(0)] - 1);
 	for (auto _ : state)
@@ -137,13 +166,14 @@ template <class S18V>
 static void BM_access_s18(benchmark::State& state) {
 	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
 
-	S18V s18(bv);
+	S18V s18 = monitored<S18V>(bv, state);
 	std::random_device g;
 	std::uniform_int_distribution<int> idx(0, SIZE[state.range(0)] - 1);
 	for (auto _ : state)
 		s18[idx(g)];
 
 	benchmark::DoNotOptimize(s18.data());
+	state.SetLabel(sdsl::s18::decoder::kernel_name());
 	state.counters["bits"] = bv.size();
 	state.counters["size"] = size_in_mega_bytes(bv);
 	state.counters["comp"] = size_in_mega_bytes(s18);
@@ -155,13 +185,32 @@ BENCHMARK_TEMPLATE(BM_access_s18, sdsl::s18::vector<8>)->DenseRange(0,35,1);
 BENCHMARK_TEMPLATE(BM_access_s18, sdsl::s18::vector<16>)->DenseRange(0,35,1);
 BENCHMARK_TEMPLATE(BM_access_s18, sdsl::s18::vector<32>)->DenseRange(0,35,1);
 BENCHMARK_TEMPLATE(BM_access_s18, sdsl::s18::vector<64>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_access_s18, sdsl::s18::vector<64, sdsl::int_vector<32>, sdsl::s18::byte_summary>)->DenseRange(0,35,1);
+
+/* Blocks laid out with their headers, against the samples of BM_access_s18 */
+template <class S18V>
+static void BM_access_s18_blocked(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+
+	S18V s18 = monitored<S18V>(bv, state);
+	std::random_device g;
+	std::uniform_int_distribution<int> idx(0, SIZE[state.range(0)] - 1);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(s18[idx(g)]);
+
+	state.counters["bits"] = bv.size();
+	state.counters["size"] = size_in_mega_bytes(bv);
+	state.counters["comp"] = size_in_mega_bytes(s18);
+}
+BENCHMARK_TEMPLATE(BM_access_s18_blocked, sdsl::s18::blocked_vector<8>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_access_s18_blocked, sdsl::s18::blocked_vector<64>)->DenseRange(0,35,1);
 
 template <class RRR>
 static void BM_access_rrr(benchmark::State& state) {
 	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
 	std::random_device g;
 
-	RRR rrr(bv);
+	RRR rrr = monitored<RRR>(bv, state);
 	std::uniform_int_distribution<int> idx(0, SIZE[state.range(0)] - 1);
 	for (auto _ : state)
 		rrr[idx(g)];
@@ -183,7 +232,7 @@ static void BM_access_sd(benchmark::State& state) {
 	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
 	std::random_device g;
 
-	SD sd(bv);
+	SD sd = monitored<SD>(bv, state);
 	std::uniform_int_distribution<int> idx(0, SIZE[state.range(0)] - 1);
 	for (auto _ : state)
 		sd[idx(g)];
@@ -199,7 +248,7 @@ static void BM_access_hyb(benchmark::State& state) {
 	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
 	std::random_device g;
 
-	sdsl::hyb_vector hv(bv);
+	sdsl::hyb_vector<> hv = monitored<sdsl::hyb_vector<>>(bv, state);
 	std::uniform_int_distribution<int> idx(0, SIZE[state.range(0)] - 1);
 	for (auto _ : state)
 		hv[idx(g)];
@@ -264,6 +313,7 @@ static void BM_rank_s18(benchmark::State& state) {
 		rs(idx(g));
 
 	benchmark::DoNotOptimize(s18.data());
+	state.SetLabel(sdsl::s18::decoder::kernel_name());
 }
 BENCHMARK_TEMPLATE(BM_rank_s18, sdsl::s18::vector<1>, sdsl::s18::rank_support<1,1>)->DenseRange(0,35,1);
 BENCHMARK_TEMPLATE(BM_rank_s18, sdsl::s18::vector<2>, sdsl::s18::rank_support<1,2>)->DenseRange(0,35,1);
@@ -272,6 +322,24 @@ BENCHMARK_TEMPLATE(BM_rank_s18, sdsl::s18::vector<8>, sdsl::s18::rank_support<1,
 BENCHMARK_TEMPLATE(BM_rank_s18, sdsl::s18::vector<16>, sdsl::s18::rank_support<1,16>)->DenseRange(0,35,1);
 BENCHMARK_TEMPLATE(BM_rank_s18, sdsl::s18::vector<32>, sdsl::s18::rank_support<1,32>)->DenseRange(0,35,1);
 BENCHMARK_TEMPLATE(BM_rank_s18, sdsl::s18::vector<64>, sdsl::s18::rank_support<1,64>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_rank_s18, sdsl::s18::vector<64, sdsl::int_vector<32>, sdsl::s18::byte_summary>, sdsl::s18::rank_support<1,64, sdsl::int_vector<32>, sdsl::s18::byte_summary>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_rank_s18, sdsl::s18::vector<64, sdsl::s18::aligned_words>, sdsl::s18::rank_support<1,64, sdsl::s18::aligned_words>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_rank_s18, sdsl::s18::vector<64, sdsl::s18::huge_words>, sdsl::s18::rank_support<1,64, sdsl::s18::huge_words>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_rank_s18, sdsl::s18::vector<8, sdsl::s18::fixed_counters<>>, sdsl::s18::rank_support<1,8, sdsl::s18::fixed_counters<>>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_rank_s18, sdsl::s18::vector<64, sdsl::s18::fixed_counters<>>, sdsl::s18::rank_support<1,64, sdsl::s18::fixed_counters<>>)->DenseRange(0,35,1);
+
+template <class S18V>
+static void BM_rank_s18_blocked(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	std::random_device g;
+
+	S18V s18(bv);
+	std::uniform_int_distribution<int> idx(0, SIZE[state.range(0)] - 1);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(s18.rank(idx(g)));
+}
+BENCHMARK_TEMPLATE(BM_rank_s18_blocked, sdsl::s18::blocked_vector<8>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_rank_s18_blocked, sdsl::s18::blocked_vector<64>)->DenseRange(0,35,1);
 
 
 template <class RRR, class RS>
@@ -380,6 +448,7 @@ static void BM_select_s18(benchmark::State& state) {
 		ss(idx(g));
 
 	benchmark::DoNotOptimize(s18.data());
+	state.SetLabel(sdsl::s18::decoder::kernel_name());
 }
 BENCHMARK_TEMPLATE(BM_select_s18, sdsl::s18::vector<1>, sdsl::s18::select_support<1,1>)->DenseRange(0,35,1);
 BENCHMARK_TEMPLATE(BM_select_s18, sdsl::s18::vector<2>, sdsl::s18::select_support<1,2>)->DenseRange(0,35,1);
@@ -388,6 +457,22 @@ BENCHMARK_TEMPLATE(BM_select_s18, sdsl::s18::vector<8>, sdsl::s18::select_suppor
 BENCHMARK_TEMPLATE(BM_select_s18, sdsl::s18::vector<16>, sdsl::s18::select_support<1,16>)->DenseRange(0,35,1);
 BENCHMARK_TEMPLATE(BM_select_s18, sdsl::s18::vector<32>, sdsl::s18::select_support<1,32>)->DenseRange(0,35,1);
 BENCHMARK_TEMPLATE(BM_select_s18, sdsl::s18::vector<64>, sdsl::s18::select_support<1,64>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_select_s18, sdsl::s18::vector<64, sdsl::int_vector<32>, sdsl::s18::byte_summary>, sdsl::s18::select_support<1,64, sdsl::int_vector<32>, sdsl::s18::byte_summary>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_select_s18, sdsl::s18::vector<64, sdsl::s18::fixed_counters<>>, sdsl::s18::select_support<1,64, sdsl::s18::fixed_counters<>>)->DenseRange(0,35,1);
+
+template <class S18V>
+static void BM_select_s18_blocked(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	std::random_device g;
+	int MAX = (int)sdsl::util::cnt_one_bits(bv);
+
+	S18V s18(bv);
+	std::uniform_int_distribution<int> idx(1, MAX);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(s18.select(idx(g)));
+}
+BENCHMARK_TEMPLATE(BM_select_s18_blocked, sdsl::s18::blocked_vector<8>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_select_s18_blocked, sdsl::s18::blocked_vector<64>)->DenseRange(0,35,1);
 
 
 template <class RRR, class SS>
@@ -429,6 +514,77 @@ static void BM_select_sd(benchmark::State& state) {
 BENCHMARK_TEMPLATE(BM_select_sd, sdsl::sd_vector<>, sdsl::select_support_sd<1>)->DenseRange(0,35,1);
 
 
+/*
+ * SELECT0
+ */
+template <class BV, class SS>
+static void BM_select0_bv(benchmark::State& state) {
+	BV &bv = test_bv(static_cast<int>(state.range(0)));
+	std::random_device g;
+	int MAX = (int)(bv.size() - sdsl::util::cnt_one_bits(bv));
+
+	SS ss(&bv);
+	std::uniform_int_distribution<int> idx(1, MAX);
+	for (auto _ : state)
+		ss(idx(g));
+
+	benchmark::DoNotOptimize(bv.data());
+}
+BENCHMARK_TEMPLATE(BM_select0_bv, sdsl::bit_vector, sdsl::select_support_mcl<0>)->DenseRange(0,35,1);
+
+template <class S18V, class SS>
+static void BM_select0_s18(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	std::random_device g;
+	int MAX = (int)(bv.size() - sdsl::util::cnt_one_bits(bv));
+
+	S18V s18(bv);
+	SS ss(s18);
+	std::uniform_int_distribution<int> idx(1, MAX);
+	for (auto _ : state)
+		ss(idx(g));
+
+	benchmark::DoNotOptimize(s18.data());
+	state.SetLabel(sdsl::s18::decoder::kernel_name());
+}
+BENCHMARK_TEMPLATE(BM_select0_s18, sdsl::s18::vector<16>, sdsl::s18::select_support<0,16>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_select0_s18, sdsl::s18::vector<64>, sdsl::s18::select_support<0,64>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_select0_s18, sdsl::s18::vector<256>, sdsl::s18::select_support<0,256>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_select0_s18, sdsl::s18::vector<64, sdsl::int_vector<32>, sdsl::s18::byte_summary>, sdsl::s18::select_support<0,64, sdsl::int_vector<32>, sdsl::s18::byte_summary>)->DenseRange(0,35,1);
+
+template <class RRR, class SS>
+static void BM_select0_rrr(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	std::random_device g;
+	int MAX = (int)(bv.size() - sdsl::util::cnt_one_bits(bv));
+
+	RRR rrr(bv);
+	SS ss(&rrr);
+	std::uniform_int_distribution<int> idx(1, MAX);
+	for (auto _ : state)
+		ss(idx(g));
+
+	benchmark::DoNotOptimize(rrr.begin());
+}
+BENCHMARK_TEMPLATE(BM_select0_rrr, sdsl::rrr_vector<63>, sdsl::select_support_rrr<0,63>)->DenseRange(0,35,1);
+
+template <class SD, class SS>
+static void BM_select0_sd(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	std::random_device g;
+	int MAX = (int)(bv.size() - sdsl::util::cnt_one_bits(bv));
+
+	SD sd(bv);
+	SS ss(&sd);
+	std::uniform_int_distribution<int> idx(1, MAX);
+	for (auto _ : state)
+		ss(idx(g));
+
+	benchmark::DoNotOptimize(sd.begin());
+}
+BENCHMARK_TEMPLATE(BM_select0_sd, sdsl::sd_vector<>, sdsl::select_support_sd<0>)->DenseRange(0,35,1);
+
+
 /*
  * SUCCESSOR
  */
@@ -485,6 +641,7 @@ static void BM_successor_s18(benchmark::State& state) {
 		ss(rs(idx(g)) + 1);
 
 	benchmark::DoNotOptimize(s18.data());
+	state.SetLabel(sdsl::s18::decoder::kernel_name());
 }
 BENCHMARK_TEMPLATE(BM_successor_s18, sdsl::s18::vector<1>, sdsl::s18::rank_support<1,1>, sdsl::s18::select_support<1,1>)->DenseRange(0,35,1);
 BENCHMARK_TEMPLATE(BM_successor_s18, sdsl::s18::vector<2>, sdsl::s18::rank_support<1,2>, sdsl::s18::select_support<1,2>)->DenseRange(0,35,1);
@@ -494,6 +651,62 @@ BENCHMARK_TEMPLATE(BM_successor_s18, sdsl::s18::vector<16>, sdsl::s18::rank_supp
 BENCHMARK_TEMPLATE(BM_successor_s18, sdsl::s18::vector<32>, sdsl::s18::rank_support<1,32>, sdsl::s18::select_support<1,32>)->DenseRange(0,35,1);
 BENCHMARK_TEMPLATE(BM_successor_s18, sdsl::s18::vector<64>, sdsl::s18::rank_support<1,64>, sdsl::s18::select_support<1,64>)->DenseRange(0,35,1);
 
+/* Single pass successor and predecessor */
+template <class S18V, class SUCC>
+static void BM_successor_s18_native(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	std::random_device g;
+
+	S18V s18(bv);
+	SUCC succ(s18);
+	std::uniform_int_distribution<int> idx(0, SIZE[state.range(0)] - 1);
+	for (auto _ : state)
+		succ(static_cast<uint64_t>(idx(g)));
+
+	benchmark::DoNotOptimize(s18.data());
+	state.SetLabel(sdsl::s18::decoder::kernel_name());
+}
+BENCHMARK_TEMPLATE(BM_successor_s18_native, sdsl::s18::vector<8>, sdsl::s18::successor_support<8>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_successor_s18_native, sdsl::s18::vector<16>, sdsl::s18::successor_support<16>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_successor_s18_native, sdsl::s18::vector<32>, sdsl::s18::successor_support<32>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_successor_s18_native, sdsl::s18::vector<64>, sdsl::s18::successor_support<64>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_successor_s18_native, sdsl::s18::vector<64>, sdsl::s18::predecessor_support<64>)->DenseRange(0,35,1);
+
+/* Full traversal of the 1 bits, through select and through the iterator */
+template <class S18V, class SS>
+static void BM_traverse_s18_select(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	S18V s18(bv);
+	SS ss(s18);
+	uint64_t const ones = sdsl::util::cnt_one_bits(bv);
+
+	for (auto _ : state) {
+		uint64_t sum = 0;
+		for (uint64_t k = 1; k <= ones; k++)
+			sum += ss(k);
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ones));
+}
+BENCHMARK_TEMPLATE(BM_traverse_s18_select, sdsl::s18::vector<64>, sdsl::s18::select_support<1,64>)->DenseRange(0,35,5);
+
+template <class S18V>
+static void BM_traverse_s18_iterator(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	S18V s18(bv);
+
+	for (auto _ : state) {
+		uint64_t sum = 0;
+		for (auto it = s18.begin_ones(); it != s18.end_ones(); ++it)
+			sum += *it;
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * sdsl::util::cnt_one_bits(bv)));
+}
+BENCHMARK_TEMPLATE(BM_traverse_s18_iterator, sdsl::s18::vector<64>)->DenseRange(0,35,5);
+
 template <class RRR, class RS, class SS>
 static void BM_successor_rrr(benchmark::State& state) {
 	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
@@ -533,4 +746,206 @@ BENCHMARK_TEMPLATE(BM_successor_sd, sdsl::sd_vector<>, sdsl::rank_support_sd<1>,
 
 
 
+/*
+ * RANGE
+ */
+template <class S18V>
+static void BM_range_s18(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	std::random_device g;
+
+	S18V s18(bv);
+	std::vector<uint64_t> out(sdsl::util::cnt_one_bits(bv));
+	uint64_t const width = bv.size() / 100;
+	std::uniform_int_distribution<uint64_t> start(0, bv.size() - width);
+	int64_t positions = 0;
+	for (auto _ : state) {
+		uint64_t const a = start(g);
+		positions += static_cast<int64_t>(s18.decode_range(a, a + width, out.data()));
+	}
+
+	benchmark::DoNotOptimize(out.data());
+	state.SetItemsProcessed(positions);
+	state.SetLabel(sdsl::s18::decoder::kernel_name());
+}
+BENCHMARK_TEMPLATE(BM_range_s18, sdsl::s18::vector<64>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_range_s18, sdsl::s18::vector<256>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_range_s18, sdsl::s18::vector<64, sdsl::int_vector<32>, sdsl::s18::byte_summary>)->DenseRange(0,35,1);
+
+/* Enumeration as rank(a) followed by a select per 1 bit */
+template <class V, class RS, class SS>
+static void BM_range_select(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	std::random_device g;
+
+	V v(bv);
+	RS rs(&v);
+	SS ss(&v);
+	std::vector<uint64_t> out(sdsl::util::cnt_one_bits(bv));
+	uint64_t const width = bv.size() / 100;
+	std::uniform_int_distribution<uint64_t> start(0, bv.size() - width);
+	int64_t positions = 0;
+	for (auto _ : state) {
+		uint64_t const a = start(g);
+		uint64_t const first = rs(a);
+		uint64_t const last = rs(a + width);
+		for (uint64_t k = first; k < last; k++)
+			out[k - first] = ss(k + 1);
+		positions += static_cast<int64_t>(last - first);
+	}
+
+	benchmark::DoNotOptimize(out.data());
+	state.SetItemsProcessed(positions);
+}
+BENCHMARK_TEMPLATE(BM_range_select, sdsl::sd_vector<>, sdsl::rank_support_sd<1>, sdsl::select_support_sd<1>)->DenseRange(0,35,1);
+BENCHMARK_TEMPLATE(BM_range_select, sdsl::rrr_vector<63>, sdsl::rank_support_rrr<1,63>, sdsl::select_support_rrr<1,63>)->DenseRange(0,35,1);
+
+
+/*
+ * BATCH
+ */
+#define BATCH 100000
+
+/* BATCH random keys below max, sorted or not */
+static std::vector<uint64_t> batch_keys(uint64_t const max, bool const sorted)
+{
+	std::random_device g;
+	std::uniform_int_distribution<uint64_t> idx(0, max - 1);
+	std::vector<uint64_t> keys(BATCH);
+	for (uint64_t &k : keys)
+		k = idx(g);
+	if (sorted)
+		std::sort(keys.begin(), keys.end());
+	return keys;
+}
+
+template <class S18V, class RS, bool SORTED>
+static void BM_rank_batch_s18(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	S18V s18(bv);
+	RS rs(s18);
+	std::vector<uint64_t> keys = batch_keys(SIZE[state.range(0)], SORTED);
+	std::vector<uint64_t> out(keys.size());
+
+	for (auto _ : state) {
+		rs.rank_batch(keys.data(), keys.size(), out.data());
+		benchmark::DoNotOptimize(out.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * BATCH);
+	state.SetLabel(sdsl::s18::decoder::kernel_name());
+}
+BENCHMARK_TEMPLATE(BM_rank_batch_s18, sdsl::s18::vector<64>, sdsl::s18::rank_support<1,64>, false)->DenseRange(0,35,5);
+BENCHMARK_TEMPLATE(BM_rank_batch_s18, sdsl::s18::vector<64>, sdsl::s18::rank_support<1,64>, true)->DenseRange(0,35,5);
+
+template <class S18V, class SS, bool SORTED>
+static void BM_select_batch_s18(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	S18V s18(bv);
+	SS ss(s18);
+	std::vector<uint64_t> keys = batch_keys(s18.ones(), SORTED);
+	for (uint64_t &k : keys)
+		k++;
+	std::vector<uint64_t> out(keys.size());
+
+	for (auto _ : state) {
+		ss.select_batch(keys.data(), keys.size(), out.data());
+		benchmark::DoNotOptimize(out.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * BATCH);
+	state.SetLabel(sdsl::s18::decoder::kernel_name());
+}
+BENCHMARK_TEMPLATE(BM_select_batch_s18, sdsl::s18::vector<64>, sdsl::s18::select_support<1,64>, false)->DenseRange(0,35,5);
+BENCHMARK_TEMPLATE(BM_select_batch_s18, sdsl::s18::vector<64>, sdsl::s18::select_support<1,64>, true)->DenseRange(0,35,5);
+
+template <class S18V, bool SORTED>
+static void BM_access_batch_s18(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	S18V s18(bv);
+	std::vector<uint64_t> keys = batch_keys(SIZE[state.range(0)], SORTED);
+	std::vector<uint64_t> out(keys.size());
+
+	for (auto _ : state) {
+		s18.access_batch(keys.data(), keys.size(), out.data());
+		benchmark::DoNotOptimize(out.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * BATCH);
+	state.SetLabel(sdsl::s18::decoder::kernel_name());
+}
+BENCHMARK_TEMPLATE(BM_access_batch_s18, sdsl::s18::vector<64>, false)->DenseRange(0,35,5);
+BENCHMARK_TEMPLATE(BM_access_batch_s18, sdsl::s18::vector<64>, true)->DenseRange(0,35,5);
+
+
+/* Random keys with G queries in flight, against BM_rank_s18 */
+template <class S18V, class RS, uint64_t G>
+static void BM_rank_interleaved_s18(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	S18V s18(bv);
+	RS rs(s18);
+	std::vector<uint64_t> keys = batch_keys(SIZE[state.range(0)], false);
+	std::vector<uint64_t> out(keys.size());
+
+	for (auto _ : state) {
+		rs.template rank_interleaved<G>(keys.data(), keys.size(), out.data());
+		benchmark::DoNotOptimize(out.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * BATCH);
+	state.SetLabel(sdsl::s18::decoder::kernel_name());
+}
+BENCHMARK_TEMPLATE(BM_rank_interleaved_s18, sdsl::s18::vector<64>, sdsl::s18::rank_support<1,64>, 4)->DenseRange(0,35,5);
+BENCHMARK_TEMPLATE(BM_rank_interleaved_s18, sdsl::s18::vector<64>, sdsl::s18::rank_support<1,64>, 16)->DenseRange(0,35,5);
+BENCHMARK_TEMPLATE(BM_rank_interleaved_s18, sdsl::s18::vector<64>, sdsl::s18::rank_support<1,64>, 32)->DenseRange(0,35,5);
+
+template <class S18V, class SS, uint64_t G>
+static void BM_select_interleaved_s18(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	S18V s18(bv);
+	SS ss(s18);
+	std::vector<uint64_t> keys = batch_keys(s18.ones(), false);
+	for (uint64_t &k : keys)
+		k++;
+	std::vector<uint64_t> out(keys.size());
+
+	for (auto _ : state) {
+		ss.template select_interleaved<G>(keys.data(), keys.size(), out.data());
+		benchmark::DoNotOptimize(out.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * BATCH);
+	state.SetLabel(sdsl::s18::decoder::kernel_name());
+}
+BENCHMARK_TEMPLATE(BM_select_interleaved_s18, sdsl::s18::vector<64>, sdsl::s18::select_support<1,64>, 16)->DenseRange(0,35,5);
+
+
+/*
+ * CURSOR
+ */
+/* Increasing keys `stride` bits apart, through a cursor and through rank_support */
+template <bool CURSOR>
+static void BM_rank_monotone_s18(benchmark::State& state) {
+	sdsl::bit_vector &bv = test_bv(static_cast<int>(state.range(0)));
+	uint64_t const stride = static_cast<uint64_t>(state.range(1));
+	sdsl::s18::vector<64> s18(bv);
+	sdsl::s18::rank_support<1, 64> rs(s18);
+	sdsl::s18::cursor<64> c(s18);
+
+	uint64_t key = 0;
+	for (auto _ : state) {
+		key += stride;
+		if (key >= bv.size()) {
+			key = 0;
+			c.reset();
+		}
+		benchmark::DoNotOptimize(CURSOR ? c.rank(key) : rs(key));
+	}
+
+	state.SetLabel(sdsl::s18::decoder::kernel_name());
+}
+BENCHMARK_TEMPLATE(BM_rank_monotone_s18, false)->ArgPair(20, 1)->ArgPair(20, 100)->ArgPair(20, 10000);
+BENCHMARK_TEMPLATE(BM_rank_monotone_s18, true)->ArgPair(20, 1)->ArgPair(20, 100)->ArgPair(20, 10000);
+
+
 BENCHMARK_MAIN();
@@ -0,0 +1,170 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <tuple>
+#include <vector>
+#include "s18_vector.hpp"
+
+#define WORDS 4096
+
+static uint32_t const CASES[17] = {
+	CASE01, CASE02, CASE03, CASE04, CASE05, CASE06, CASE07, CASE08, CASE09,
+	CASE10, CASE11, CASE12, CASE13, CASE14, CASE15, CASE16, CASE17
+};
+static uint64_t const BITS[17]   = {28,14, 9, 7, 4, 3, 2,28,14, 9, 7, 4, 3, 2, 5, 0, 5};
+static uint64_t const CHUNKS[17] = { 1, 2, 3, 4, 7, 9,14, 1, 2, 3, 4, 7, 9,14, 5, 0, 5};
+
+/* Full words of case c (0 to 16), or of random cases when c is 17 */
+std::vector<uint32_t> const &test_words(int64_t c)
+{
+	static std::vector<uint32_t> words[18];
+	if (words[c].size())
+		return words[c];
+
+	std::mt19937 g(static_cast<uint32_t>(c));
+	std::uniform_int_distribution<uint64_t> rc(0, 16);
+	for (uint64_t i = 0; i < WORDS; i++) {
+		uint64_t const C = c < 17 ? static_cast<uint64_t>(c) : rc(g);
+		uint32_t w = CASES[C];
+
+		if (C == 15) {
+			std::uniform_int_distribution<uint32_t> run(1, MASK_BODY5);
+			words[c].push_back(w | run(g));
+			continue;
+		}
+
+		std::uniform_int_distribution<uint32_t> chunk(1, static_cast<uint32_t>((uint64_t(1) << BITS[C]) - 1));
+		for (uint64_t j = 0; j < CHUNKS[C]; j++)
+			w |= chunk(g) << (BITS[C] * (CHUNKS[C] - j - 1));
+		words[c].push_back(w);
+	}
+
+	return words[c];
+}
+
+/* Header dispatch as done before the descriptor table */
+static std::tuple<uint64_t, uint64_t, uint64_t> metadata_switch(uint32_t const value)
+{
+	switch (value & MASK_HEADER4) {
+		case CASE01: return std::make_tuple(0,  0, CHUNKS_CASE01);
+		case CASE02: return std::make_tuple(1,  0, CHUNKS_CASE02);
+		case CASE03: return std::make_tuple(2,  0, CHUNKS_CASE03);
+		case CASE04: return std::make_tuple(3,  0, CHUNKS_CASE04);
+		case CASE05: return std::make_tuple(4,  0, CHUNKS_CASE05);
+		case CASE06: return std::make_tuple(5,  0, CHUNKS_CASE06);
+		case CASE07: return std::make_tuple(6,  0, CHUNKS_CASE07);
+		case CASE08: return std::make_tuple(0, 28, CHUNKS_CASE01);
+		case CASE09: return std::make_tuple(1, 28, CHUNKS_CASE02);
+		case CASE10: return std::make_tuple(2, 28, CHUNKS_CASE03);
+		case CASE11: return std::make_tuple(3, 28, CHUNKS_CASE04);
+		case CASE12: return std::make_tuple(4, 28, CHUNKS_CASE05);
+		case CASE13: return std::make_tuple(5, 28, CHUNKS_CASE06);
+		case CASE14: return std::make_tuple(6, 28, CHUNKS_CASE07);
+		case CASE15: return std::make_tuple(16, 28, CHUNKS_CASE17);
+		default: switch (value & MASK_HEADER5) {
+			case CASE16: return std::make_tuple(15, (value & MASK_BODY5), 0);
+			case CASE17: return std::make_tuple(16, 0, CHUNKS_CASE17);
+			default: throw std::invalid_argument("metadata_switch: Invalid case");
+		}
+	}
+}
+
+/*
+ * WORD DECODE
+ */
+static void BM_word_decode_switch(benchmark::State& state) {
+	std::vector<uint32_t> const &words = test_words(state.range(0));
+
+	for (auto _ : state) {
+		uint64_t accum = 0;
+		for (uint32_t const v : words) {
+			sdsl::s18::word w(v);
+			auto const [_case, leading_1s, len] = metadata_switch(v);
+
+			accum += leading_1s;
+			for (uint64_t i = 0; i < len; i++) {
+				uint64_t wi = w.access_fast(i, _case);
+				if (wi == 0) break; /* Word was not full */
+				accum += wi;
+			}
+		}
+		benchmark::DoNotOptimize(accum);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * words.size()));
+}
+BENCHMARK(BM_word_decode_switch)->DenseRange(0,17,1);
+
+static void BM_word_decode_table(benchmark::State& state) {
+	std::vector<uint32_t> const &words = test_words(state.range(0));
+
+	for (auto _ : state) {
+		uint64_t accum = 0;
+		for (uint32_t const v : words) {
+			sdsl::s18::word w(v);
+			auto const [_case, leading_1s, len] = w.metadata();
+
+			accum += leading_1s;
+			for (uint64_t i = 0; i < len; i++) {
+				uint64_t wi = w.access_fast(i, _case);
+				if (wi == 0) break; /* Word was not full */
+				accum += wi;
+			}
+		}
+		benchmark::DoNotOptimize(accum);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * words.size()));
+}
+BENCHMARK(BM_word_decode_table)->DenseRange(0,17,1);
+
+static void BM_word_decode_bulk(benchmark::State& state) {
+	std::vector<uint32_t> const &words = test_words(state.range(0));
+	std::vector<uint32_t> gaps(words.size() * sdsl::s18::decoder::MAX_WORD_GAPS + sdsl::s18::decoder::PADDING);
+
+	for (auto _ : state) {
+		uint64_t len = sdsl::s18::decoder::decode(words.data(), words.size(), gaps.data());
+		benchmark::DoNotOptimize(len);
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * words.size()));
+	state.SetLabel(sdsl::s18::decoder::kernel_name());
+}
+BENCHMARK(BM_word_decode_bulk)->DenseRange(0,17,1);
+
+/* Every kernel the CPU supports, on mixed words */
+static void BM_word_decode_kernel(benchmark::State& state) {
+	std::vector<sdsl::s18::decoder::kernel const *> const &kernels = sdsl::s18::decoder::supported();
+	if (static_cast<uint64_t>(state.range(0)) >= kernels.size()) {
+		state.SkipWithError("Kernel not supported by this CPU");
+		return;
+	}
+
+	sdsl::s18::decoder::kernel const &k = *kernels[static_cast<uint64_t>(state.range(0))];
+	std::vector<uint32_t> const &words = test_words(17);
+	std::vector<uint32_t> gaps(words.size() * sdsl::s18::decoder::MAX_WORD_GAPS + sdsl::s18::decoder::PADDING);
+
+	for (auto _ : state) {
+		uint64_t len = k.decode(words.data(), words.size(), gaps.data());
+		benchmark::DoNotOptimize(len);
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * words.size()));
+	state.SetLabel(k.name);
+}
+BENCHMARK(BM_word_decode_kernel)->DenseRange(0,4,1);
+
+static void BM_word_decode_swar(benchmark::State& state) {
+	std::vector<uint32_t> const &words = test_words(state.range(0));
+
+	for (auto _ : state) {
+		uint64_t accum = 0;
+		for (uint32_t const v : words)
+			accum += sdsl::s18::decoder::span(v);
+		benchmark::DoNotOptimize(accum);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * words.size()));
+}
+BENCHMARK(BM_word_decode_swar)->DenseRange(0,17,1);
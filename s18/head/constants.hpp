@@ -76,4 +76,57 @@
 #define CHUNKS_CASE15 ( 5)
 #define CHUNKS_CASE17 ( 5)
 
+/*
+ * SWAR chunk sums
+ *
+ * Adjacent chunks are added pairwise twice (shifting by BITS and 2 * BITS
+ * and masking with FOLD1 and FOLD2), then the remaining fields are added
+ * by multiplying with MULT. The sum ends up at SHIFT, masked by MASK.
+ * C8-C14 share their chunks with C1-C7 and C15 with C17.
+ */
+#define SWAR_FOLD1_CASE01 (0x0FFFFFFF)
+#define SWAR_FOLD1_CASE02 (0x00003FFF)
+#define SWAR_FOLD1_CASE03 (0x07FC01FF)
+#define SWAR_FOLD1_CASE04 (0x001FC07F)
+#define SWAR_FOLD1_CASE05 (0x0F0F0F0F)
+#define SWAR_FOLD1_CASE06 (0x071C71C7)
+#define SWAR_FOLD1_CASE07 (0x03333333)
+#define SWAR_FOLD1_CASE17 (0x01F07C1F)
+
+#define SWAR_FOLD2_CASE01 (0x0FFFFFFF)
+#define SWAR_FOLD2_CASE02 (0x0FFFFFFF)
+#define SWAR_FOLD2_CASE03 (0x0003FFFF)
+#define SWAR_FOLD2_CASE04 (0x00003FFF)
+#define SWAR_FOLD2_CASE05 (0x00FF00FF)
+#define SWAR_FOLD2_CASE06 (0x3F03F03F)
+#define SWAR_FOLD2_CASE07 (0x0F0F0F0F)
+#define SWAR_FOLD2_CASE17 (0x3FF003FF)
+
+#define SWAR_MULT_CASE01 (0x00000001)
+#define SWAR_MULT_CASE02 (0x00000001)
+#define SWAR_MULT_CASE03 (0x00000001)
+#define SWAR_MULT_CASE04 (0x00000001)
+#define SWAR_MULT_CASE05 (0x00010001)
+#define SWAR_MULT_CASE06 (0x01001001)
+#define SWAR_MULT_CASE07 (0x01010101)
+#define SWAR_MULT_CASE17 (0x00100001)
+
+#define SWAR_SHIFT_CASE01 ( 0)
+#define SWAR_SHIFT_CASE02 ( 0)
+#define SWAR_SHIFT_CASE03 ( 0)
+#define SWAR_SHIFT_CASE04 ( 0)
+#define SWAR_SHIFT_CASE05 (16)
+#define SWAR_SHIFT_CASE06 (24)
+#define SWAR_SHIFT_CASE07 (24)
+#define SWAR_SHIFT_CASE17 (20)
+
+#define SWAR_MASK_CASE01 (0x0FFFFFFF)
+#define SWAR_MASK_CASE02 (0x00007FFF)
+#define SWAR_MASK_CASE03 (0x000007FF)
+#define SWAR_MASK_CASE04 (0x000001FF)
+#define SWAR_MASK_CASE05 (0x000000FF)
+#define SWAR_MASK_CASE06 (0x000000FF)
+#define SWAR_MASK_CASE07 (0x000000FF)
+#define SWAR_MASK_CASE17 (0x000000FF)
+
 #endif
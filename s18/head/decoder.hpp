@@ -0,0 +1,563 @@
+/*
+ * decoder: Bulk decoding of S18 words into gap arrays
+ * Copyright (C) 2019  Manuel Weitzman
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDED_SDSL_S18_DECODER
+#define INCLUDED_SDSL_S18_DECODER
+
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define S18_X86 1
+#include <immintrin.h>
+#else
+#define S18_X86 0
+#endif
+
+#include "constants.hpp"
+
+
+namespace sdsl
+{
+namespace s18
+{
+
+/*
+ * Bulk decoder
+ *
+ * Turns a run of S18 words into a contiguous array of gaps. Every chunk
+ * becomes one entry; runs of 1s (the 28 leading 1s of C8-C15 and the whole
+ * body of C16) become a single entry flagged with RUN whose low bits hold
+ * the length of the run.
+ *
+ * Decoding and word skipping are compiled once per instruction set; the
+ * best kernel the CPU supports is picked through CPUID on first use.
+ */
+class decoder
+{
+	public:
+		/* Flag for entries holding a run of 1s */
+		static uint32_t constexpr RUN = 0x80000000;
+
+		/* Entries a single word may expand to (one run plus 14 chunks) */
+		static uint64_t constexpr MAX_WORD_GAPS = 15;
+
+		/* Vector kernels may write this many entries past the decoded end */
+		static uint64_t constexpr PADDING = 16;
+
+		/* Word header descriptor, see describe() */
+		struct descriptor
+		{
+			uint8_t  id;        // Case as int, 0 for C1 up to 16 for C17
+			uint8_t  leading;   // Leading 1s, without the ones in run_mask
+			uint8_t  bits;      // Width of a chunk
+			uint8_t  chunks;    // Chunks after the leading 1s
+			uint32_t run_mask;  // Bits of the word holding a run of 1s (C16)
+			uint32_t marks;     // Lowest bit of every chunk plus one above the last
+		};
+
+		/* Marks for a case, 1 for C16 which has no chunks */
+		static constexpr uint32_t chunk_marks(uint32_t bits, uint32_t chunks)
+		{
+			uint32_t m = 0;
+			for (uint32_t i = 0; i <= chunks; i++)
+				m |= 1u << (bits * i);
+			return m;
+		}
+
+		/* Describe a word by its 5 most significant bits, valid for every word */
+		static descriptor const &describe(uint32_t const w)
+		{
+			/* C1-C15 use 4 bit headers, hence they appear twice */
+			static constexpr descriptor DESCRIPTORS[32] = {
+				{ 0,  0, BITS_CASE01, CHUNKS_CASE01, 0, chunk_marks(BITS_CASE01, CHUNKS_CASE01)},
+				{ 0,  0, BITS_CASE01, CHUNKS_CASE01, 0, chunk_marks(BITS_CASE01, CHUNKS_CASE01)},
+				{ 1,  0, BITS_CASE02, CHUNKS_CASE02, 0, chunk_marks(BITS_CASE02, CHUNKS_CASE02)},
+				{ 1,  0, BITS_CASE02, CHUNKS_CASE02, 0, chunk_marks(BITS_CASE02, CHUNKS_CASE02)},
+				{ 2,  0, BITS_CASE03, CHUNKS_CASE03, 0, chunk_marks(BITS_CASE03, CHUNKS_CASE03)},
+				{ 2,  0, BITS_CASE03, CHUNKS_CASE03, 0, chunk_marks(BITS_CASE03, CHUNKS_CASE03)},
+				{ 3,  0, BITS_CASE04, CHUNKS_CASE04, 0, chunk_marks(BITS_CASE04, CHUNKS_CASE04)},
+				{ 3,  0, BITS_CASE04, CHUNKS_CASE04, 0, chunk_marks(BITS_CASE04, CHUNKS_CASE04)},
+				{ 4,  0, BITS_CASE05, CHUNKS_CASE05, 0, chunk_marks(BITS_CASE05, CHUNKS_CASE05)},
+				{ 4,  0, BITS_CASE05, CHUNKS_CASE05, 0, chunk_marks(BITS_CASE05, CHUNKS_CASE05)},
+				{ 5,  0, BITS_CASE06, CHUNKS_CASE06, 0, chunk_marks(BITS_CASE06, CHUNKS_CASE06)},
+				{ 5,  0, BITS_CASE06, CHUNKS_CASE06, 0, chunk_marks(BITS_CASE06, CHUNKS_CASE06)},
+				{ 6,  0, BITS_CASE07, CHUNKS_CASE07, 0, chunk_marks(BITS_CASE07, CHUNKS_CASE07)},
+				{ 6,  0, BITS_CASE07, CHUNKS_CASE07, 0, chunk_marks(BITS_CASE07, CHUNKS_CASE07)},
+				{ 7, 28, BITS_CASE08, CHUNKS_CASE08, 0, chunk_marks(BITS_CASE08, CHUNKS_CASE08)},
+				{ 7, 28, BITS_CASE08, CHUNKS_CASE08, 0, chunk_marks(BITS_CASE08, CHUNKS_CASE08)},
+				{ 8, 28, BITS_CASE09, CHUNKS_CASE09, 0, chunk_marks(BITS_CASE09, CHUNKS_CASE09)},
+				{ 8, 28, BITS_CASE09, CHUNKS_CASE09, 0, chunk_marks(BITS_CASE09, CHUNKS_CASE09)},
+				{ 9, 28, BITS_CASE10, CHUNKS_CASE10, 0, chunk_marks(BITS_CASE10, CHUNKS_CASE10)},
+				{ 9, 28, BITS_CASE10, CHUNKS_CASE10, 0, chunk_marks(BITS_CASE10, CHUNKS_CASE10)},
+				{10, 28, BITS_CASE11, CHUNKS_CASE11, 0, chunk_marks(BITS_CASE11, CHUNKS_CASE11)},
+				{10, 28, BITS_CASE11, CHUNKS_CASE11, 0, chunk_marks(BITS_CASE11, CHUNKS_CASE11)},
+				{11, 28, BITS_CASE12, CHUNKS_CASE12, 0, chunk_marks(BITS_CASE12, CHUNKS_CASE12)},
+				{11, 28, BITS_CASE12, CHUNKS_CASE12, 0, chunk_marks(BITS_CASE12, CHUNKS_CASE12)},
+				{12, 28, BITS_CASE13, CHUNKS_CASE13, 0, chunk_marks(BITS_CASE13, CHUNKS_CASE13)},
+				{12, 28, BITS_CASE13, CHUNKS_CASE13, 0, chunk_marks(BITS_CASE13, CHUNKS_CASE13)},
+				{13, 28, BITS_CASE14, CHUNKS_CASE14, 0, chunk_marks(BITS_CASE14, CHUNKS_CASE14)},
+				{13, 28, BITS_CASE14, CHUNKS_CASE14, 0, chunk_marks(BITS_CASE14, CHUNKS_CASE14)},
+				{14, 28, BITS_CASE15, CHUNKS_CASE15, 0, chunk_marks(BITS_CASE15, CHUNKS_CASE15)},
+				{14, 28, BITS_CASE15, CHUNKS_CASE15, 0, chunk_marks(BITS_CASE15, CHUNKS_CASE15)},
+				{15,  0,           0,             0, MASK_BODY5, chunk_marks(0, 0)},
+				{16,  0, BITS_CASE17, CHUNKS_CASE17, 0, chunk_marks(BITS_CASE17, CHUNKS_CASE17)},
+			};
+
+			return DESCRIPTORS[w >> 27];
+		}
+
+		/* Amount of 1 bits encoded by a word, without extracting its chunks */
+		static uint64_t ones(uint32_t const w)
+		{
+			descriptor const &d = describe(w);
+
+			/* Marks above the lowest set bit of the body belong to used chunks */
+			uint32_t const top = 1u << (31 - __builtin_clz(d.marks));
+			uint32_t const low = static_cast<uint32_t>(__builtin_ctz((w & (top - 1)) | top));
+			return d.leading + (w & d.run_mask) + static_cast<uint64_t>(__builtin_popcount(d.marks >> low >> 1));
+		}
+
+	private:
+		struct layout
+		{
+			alignas(64) uint32_t shift[16];  // Right shift for each chunk
+			alignas(64) uint32_t mask[16];   // Mask for each chunk, 0 if unused
+			alignas(64) uint32_t mult[16];   // 2^(32 - shift - bits), 0 if unused
+			uint32_t             bits;
+			uint32_t             lead;       // Entry emitted before chunks
+			uint32_t             run_mask;   // Bits of the word added to lead
+		};
+
+		static constexpr layout make_layout(uint32_t bits, uint32_t chunks, uint32_t lead, uint32_t run_mask)
+		{
+			layout l = {{0}, {0}, {0}, bits, lead, run_mask};
+			for (uint32_t i = 0; i < chunks; i++) {
+				l.shift[i] = bits * (chunks - i - 1);
+				l.mask[i] = (1u << bits) - 1;
+				l.mult[i] = 1u << (32 - l.shift[i] - bits);
+			}
+			return l;
+		}
+
+		static layout const &layout_of(uint32_t const w)
+		{
+			static constexpr layout LAYOUT[17] = {
+				make_layout(BITS_CASE01, CHUNKS_CASE01, 0, 0),
+				make_layout(BITS_CASE02, CHUNKS_CASE02, 0, 0),
+				make_layout(BITS_CASE03, CHUNKS_CASE03, 0, 0),
+				make_layout(BITS_CASE04, CHUNKS_CASE04, 0, 0),
+				make_layout(BITS_CASE05, CHUNKS_CASE05, 0, 0),
+				make_layout(BITS_CASE06, CHUNKS_CASE06, 0, 0),
+				make_layout(BITS_CASE07, CHUNKS_CASE07, 0, 0),
+				make_layout(BITS_CASE08, CHUNKS_CASE08, RUN | 28, 0),
+				make_layout(BITS_CASE09, CHUNKS_CASE09, RUN | 28, 0),
+				make_layout(BITS_CASE10, CHUNKS_CASE10, RUN | 28, 0),
+				make_layout(BITS_CASE11, CHUNKS_CASE11, RUN | 28, 0),
+				make_layout(BITS_CASE12, CHUNKS_CASE12, RUN | 28, 0),
+				make_layout(BITS_CASE13, CHUNKS_CASE13, RUN | 28, 0),
+				make_layout(BITS_CASE14, CHUNKS_CASE14, RUN | 28, 0),
+				make_layout(BITS_CASE15, CHUNKS_CASE15, RUN | 28, 0),
+				make_layout(0,           0,             RUN,      MASK_BODY5),
+				make_layout(BITS_CASE17, CHUNKS_CASE17, 0, 0),
+			};
+
+			return LAYOUT[describe(w).id];
+		}
+
+	public:
+		/* Amount of bits spanned by a word, i.e. the sum of its gaps */
+		static uint64_t span(uint32_t const w)
+		{
+			descriptor const &d = describe(w);
+			return d.leading + (w & d.run_mask) + chunk_sum(w, d.chunks);
+		}
+
+		/* Sum of the first `k` chunks of a word, without extracting them */
+		static uint64_t chunk_sum(uint32_t const w, uint64_t const k)
+		{
+			descriptor const &d = describe(w);
+			swar const &s = swar_of(d.id);
+
+			uint64_t t = (w & s.body) >> (d.bits * (d.chunks - k));
+			t = (t & s.fold1) + ((t >> d.bits) & s.fold1);
+			t = (t & s.fold2) + ((t >> (2 * d.bits)) & s.fold2);
+			return ((t * s.mult) >> s.shift) & s.mask;
+		}
+
+		/*
+		 * Least amount of chunks whose sum reaches `x`, the sum is left in
+		 * `reached`. Binary search over chunk_sum, so O(log chunks) of them.
+		 */
+		static uint64_t first_reaching(uint32_t const w, uint64_t const x, uint64_t &reached)
+		{
+			uint64_t lo = 1;
+			uint64_t hi = describe(w).chunks;
+			while (lo < hi) {
+				uint64_t const mid = (lo + hi) / 2;
+				if (chunk_sum(w, mid) >= x) hi = mid;
+				else lo = mid + 1;
+			}
+			reached = chunk_sum(w, lo);
+			return lo;
+		}
+
+	private:
+		/* SWAR chunk sum constants, see constants.hpp */
+		struct swar
+		{
+			uint64_t body;   // Bits of the word holding chunks
+			uint64_t fold1;
+			uint64_t fold2;
+			uint64_t mult;
+			uint64_t shift;
+			uint64_t mask;
+		};
+
+		static constexpr swar make_swar(uint32_t chunks, uint32_t bits, uint64_t fold1, uint64_t fold2, uint64_t mult, uint64_t shift, uint64_t mask)
+		{
+			return {(uint64_t(1) << (chunks * bits)) - 1, fold1, fold2, mult, shift, mask};
+		}
+
+		static swar const &swar_of(uint8_t const id)
+		{
+			static constexpr swar SWAR[17] = {
+				make_swar(CHUNKS_CASE01, BITS_CASE01, SWAR_FOLD1_CASE01, SWAR_FOLD2_CASE01, SWAR_MULT_CASE01, SWAR_SHIFT_CASE01, SWAR_MASK_CASE01),
+				make_swar(CHUNKS_CASE02, BITS_CASE02, SWAR_FOLD1_CASE02, SWAR_FOLD2_CASE02, SWAR_MULT_CASE02, SWAR_SHIFT_CASE02, SWAR_MASK_CASE02),
+				make_swar(CHUNKS_CASE03, BITS_CASE03, SWAR_FOLD1_CASE03, SWAR_FOLD2_CASE03, SWAR_MULT_CASE03, SWAR_SHIFT_CASE03, SWAR_MASK_CASE03),
+				make_swar(CHUNKS_CASE04, BITS_CASE04, SWAR_FOLD1_CASE04, SWAR_FOLD2_CASE04, SWAR_MULT_CASE04, SWAR_SHIFT_CASE04, SWAR_MASK_CASE04),
+				make_swar(CHUNKS_CASE05, BITS_CASE05, SWAR_FOLD1_CASE05, SWAR_FOLD2_CASE05, SWAR_MULT_CASE05, SWAR_SHIFT_CASE05, SWAR_MASK_CASE05),
+				make_swar(CHUNKS_CASE06, BITS_CASE06, SWAR_FOLD1_CASE06, SWAR_FOLD2_CASE06, SWAR_MULT_CASE06, SWAR_SHIFT_CASE06, SWAR_MASK_CASE06),
+				make_swar(CHUNKS_CASE07, BITS_CASE07, SWAR_FOLD1_CASE07, SWAR_FOLD2_CASE07, SWAR_MULT_CASE07, SWAR_SHIFT_CASE07, SWAR_MASK_CASE07),
+				make_swar(CHUNKS_CASE08, BITS_CASE08, SWAR_FOLD1_CASE01, SWAR_FOLD2_CASE01, SWAR_MULT_CASE01, SWAR_SHIFT_CASE01, SWAR_MASK_CASE01),
+				make_swar(CHUNKS_CASE09, BITS_CASE09, SWAR_FOLD1_CASE02, SWAR_FOLD2_CASE02, SWAR_MULT_CASE02, SWAR_SHIFT_CASE02, SWAR_MASK_CASE02),
+				make_swar(CHUNKS_CASE10, BITS_CASE10, SWAR_FOLD1_CASE03, SWAR_FOLD2_CASE03, SWAR_MULT_CASE03, SWAR_SHIFT_CASE03, SWAR_MASK_CASE03),
+				make_swar(CHUNKS_CASE11, BITS_CASE11, SWAR_FOLD1_CASE04, SWAR_FOLD2_CASE04, SWAR_MULT_CASE04, SWAR_SHIFT_CASE04, SWAR_MASK_CASE04),
+				make_swar(CHUNKS_CASE12, BITS_CASE12, SWAR_FOLD1_CASE05, SWAR_FOLD2_CASE05, SWAR_MULT_CASE05, SWAR_SHIFT_CASE05, SWAR_MASK_CASE05),
+				make_swar(CHUNKS_CASE13, BITS_CASE13, SWAR_FOLD1_CASE06, SWAR_FOLD2_CASE06, SWAR_MULT_CASE06, SWAR_SHIFT_CASE06, SWAR_MASK_CASE06),
+				make_swar(CHUNKS_CASE14, BITS_CASE14, SWAR_FOLD1_CASE07, SWAR_FOLD2_CASE07, SWAR_MULT_CASE07, SWAR_SHIFT_CASE07, SWAR_MASK_CASE07),
+				make_swar(CHUNKS_CASE15, BITS_CASE15, SWAR_FOLD1_CASE17, SWAR_FOLD2_CASE17, SWAR_MULT_CASE17, SWAR_SHIFT_CASE17, SWAR_MASK_CASE17),
+				make_swar(0, 0, 0, 0, 0, 0, 0),
+				make_swar(CHUNKS_CASE17, BITS_CASE17, SWAR_FOLD1_CASE17, SWAR_FOLD2_CASE17, SWAR_MULT_CASE17, SWAR_SHIFT_CASE17, SWAR_MASK_CASE17),
+			};
+
+			return SWAR[id];
+		}
+
+	public:
+		/* Decoding and scanning routines built for one instruction set */
+		struct kernel
+		{
+			char const *name;
+
+			/* Decode `n` words into `out`, returns the amount of entries written */
+			uint64_t (*decode)(uint32_t const *words, uint64_t n, uint32_t *out);
+
+			/* Skip words while they end before bit `target`, returns words skipped */
+			uint64_t (*skip_bits)(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t target, uint64_t &accum, uint64_t &ones);
+
+			/* Skip words while they hold no more than `counter` 1s, returns words skipped */
+			uint64_t (*skip_ones)(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t &counter, uint64_t &accum);
+		};
+
+		/* Kernels the running CPU supports, best first */
+		static std::vector<kernel const *> const &supported(void)
+		{
+			static std::vector<kernel const *> const SUPPORTED = probe();
+			return SUPPORTED;
+		}
+
+		/* Kernel used by decode() and the query scans, picked on first use */
+		static kernel const &active(void)
+		{
+			static kernel const &ACTIVE = *supported().front();
+			return ACTIVE;
+		}
+
+		static char const *kernel_name(void)
+		{
+			return active().name;
+		}
+
+		static uint64_t decode(uint32_t const *words, uint64_t n, uint32_t *out)
+		{
+			return active().decode(words, n, out);
+		}
+
+		/* Spans are read from `spans` when given and not 0, computed otherwise */
+		static uint64_t skip_bits(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t target, uint64_t &accum, uint64_t &ones)
+		{
+			return active().skip_bits(words, spans, n, target, accum, ones);
+		}
+
+		static uint64_t skip_ones(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t &counter, uint64_t &accum)
+		{
+			return active().skip_ones(words, spans, n, counter, accum);
+		}
+
+	private:
+		static std::vector<kernel const *> probe(void)
+		{
+			std::vector<kernel const *> k;
+#if S18_X86
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx512f") and __builtin_cpu_supports("bmi2") and __builtin_cpu_supports("popcnt"))
+				k.push_back(&AVX512);
+			if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("bmi2") and __builtin_cpu_supports("popcnt"))
+				k.push_back(&AVX2);
+			if (__builtin_cpu_supports("sse4.1") and __builtin_cpu_supports("popcnt"))
+				k.push_back(&SSE4);
+			if (__builtin_cpu_supports("bmi2") and __builtin_cpu_supports("popcnt"))
+				k.push_back(&BMI2);
+#endif
+			k.push_back(&SCALAR);
+			return k;
+		}
+
+		/* Bodies shared by every kernel, inlined into each target */
+		__attribute__((always_inline))
+		static inline uint64_t skip_bits_body(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t target, uint64_t &accum, uint64_t &ones)
+		{
+			uint64_t a = accum;
+			uint64_t o = ones;
+			uint64_t i = 0;
+			for (; i < n; i++) {
+				uint64_t const s = spans and spans[i] ? spans[i] : span(words[i]);
+				if (a + s >= target) break;
+				a += s;
+				o += decoder::ones(words[i]);
+			}
+			accum = a;
+			ones = o;
+			return i;
+		}
+
+		__attribute__((always_inline))
+		static inline uint64_t skip_ones_body(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t &counter, uint64_t &accum)
+		{
+			uint64_t c = counter;
+			uint64_t a = accum;
+			uint64_t i = 0;
+			for (; i < n; i++) {
+				uint64_t const o = decoder::ones(words[i]);
+				if (o > c) break;
+				a += spans and spans[i] ? spans[i] : span(words[i]);
+				c -= o;
+			}
+			counter = c;
+			accum = a;
+			return i;
+		}
+
+	public:
+		static uint64_t decode_scalar(uint32_t const *words, uint64_t n, uint32_t *out)
+		{
+			uint32_t *const begin = out;
+			for (uint32_t const *w = words; w != words + n; w++) {
+				layout const &l = layout_of(*w);
+				*out = l.lead | (*w & l.run_mask);
+				out += *out != 0;
+
+				for (uint64_t i = 0; i < 14 and l.mask[i]; i++) {
+					uint32_t const gap = (*w >> l.shift[i]) & l.mask[i];
+					if (gap == 0) break; /* Word was not full */
+					*out++ = gap;
+				}
+			}
+			return static_cast<uint64_t>(out - begin);
+		}
+
+	private:
+		static uint64_t skip_bits_scalar(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t target, uint64_t &accum, uint64_t &ones)
+		{
+			return skip_bits_body(words, spans, n, target, accum, ones);
+		}
+
+		static uint64_t skip_ones_scalar(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t &counter, uint64_t &accum)
+		{
+			return skip_ones_body(words, spans, n, counter, accum);
+		}
+
+		static constexpr kernel SCALAR = {"scalar", decode_scalar, skip_bits_scalar, skip_ones_scalar};
+
+#if S18_X86
+		/* Chunks are gathered with pext instead of a shift and a mask */
+		__attribute__((target("bmi2,popcnt")))
+		static uint64_t decode_bmi2(uint32_t const *words, uint64_t n, uint32_t *out)
+		{
+			uint32_t *const begin = out;
+			for (uint32_t const *w = words; w != words + n; w++) {
+				layout const &l = layout_of(*w);
+				*out = l.lead | (*w & l.run_mask);
+				out += *out != 0;
+
+				for (uint64_t i = 0; i < 14 and l.mask[i]; i++) {
+					uint32_t const gap = _pext_u32(*w, l.mask[i] << l.shift[i]);
+					if (gap == 0) break; /* Word was not full */
+					*out++ = gap;
+				}
+			}
+			return static_cast<uint64_t>(out - begin);
+		}
+
+		__attribute__((target("bmi2,popcnt")))
+		static uint64_t skip_bits_bmi2(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t target, uint64_t &accum, uint64_t &ones)
+		{
+			return skip_bits_body(words, spans, n, target, accum, ones);
+		}
+
+		__attribute__((target("bmi2,popcnt")))
+		static uint64_t skip_ones_bmi2(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t &counter, uint64_t &accum)
+		{
+			return skip_ones_body(words, spans, n, counter, accum);
+		}
+
+		static constexpr kernel BMI2 = {"bmi2", decode_bmi2, skip_bits_bmi2, skip_ones_bmi2};
+
+		__attribute__((target("sse4.1,popcnt")))
+		static uint64_t decode_sse4(uint32_t const *words, uint64_t n, uint32_t *out)
+		{
+			uint32_t *const begin = out;
+			__m128i const zero = _mm_setzero_si128();
+			for (uint32_t const *w = words; w != words + n; w++) {
+				layout const &l = layout_of(*w);
+				*out = l.lead | (*w & l.run_mask);
+				out += *out != 0;
+
+				/* Shift chunks to the top of each lane, then down to bit 0 */
+				__m128i const v = _mm_set1_epi32(static_cast<int>(*w));
+				__m128i const s = _mm_cvtsi32_si128(static_cast<int>(32 - l.bits));
+				__m128i const c0 = _mm_srl_epi32(_mm_mullo_epi32(v, _mm_load_si128(reinterpret_cast<__m128i const *>(l.mult) + 0)), s);
+				__m128i const c1 = _mm_srl_epi32(_mm_mullo_epi32(v, _mm_load_si128(reinterpret_cast<__m128i const *>(l.mult) + 1)), s);
+				__m128i const c2 = _mm_srl_epi32(_mm_mullo_epi32(v, _mm_load_si128(reinterpret_cast<__m128i const *>(l.mult) + 2)), s);
+				__m128i const c3 = _mm_srl_epi32(_mm_mullo_epi32(v, _mm_load_si128(reinterpret_cast<__m128i const *>(l.mult) + 3)), s);
+
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out) + 0, c0);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out) + 1, c1);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out) + 2, c2);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out) + 3, c3);
+
+				/* Chunks are never 0, so only the trailing unused ones are */
+				__m128i const z01 = _mm_packs_epi32(_mm_cmpeq_epi32(c0, zero), _mm_cmpeq_epi32(c1, zero));
+				__m128i const z23 = _mm_packs_epi32(_mm_cmpeq_epi32(c2, zero), _mm_cmpeq_epi32(c3, zero));
+				uint32_t const zeros = static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(z01, z23)));
+				out += 16 - __builtin_popcount(zeros);
+			}
+			return static_cast<uint64_t>(out - begin);
+		}
+
+		__attribute__((target("sse4.1,popcnt")))
+		static uint64_t skip_bits_sse4(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t target, uint64_t &accum, uint64_t &ones)
+		{
+			return skip_bits_body(words, spans, n, target, accum, ones);
+		}
+
+		__attribute__((target("sse4.1,popcnt")))
+		static uint64_t skip_ones_sse4(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t &counter, uint64_t &accum)
+		{
+			return skip_ones_body(words, spans, n, counter, accum);
+		}
+
+		static constexpr kernel SSE4 = {"sse4.1", decode_sse4, skip_bits_sse4, skip_ones_sse4};
+
+		__attribute__((target("avx2,bmi2,popcnt")))
+		static uint64_t decode_avx2(uint32_t const *words, uint64_t n, uint32_t *out)
+		{
+			uint32_t *const begin = out;
+			__m256i const zero = _mm256_setzero_si256();
+			for (uint32_t const *w = words; w != words + n; w++) {
+				layout const &l = layout_of(*w);
+				*out = l.lead | (*w & l.run_mask);
+				out += *out != 0;
+
+				__m256i const v = _mm256_set1_epi32(static_cast<int>(*w));
+				__m256i const lo = _mm256_and_si256(
+					_mm256_srlv_epi32(v, _mm256_load_si256(reinterpret_cast<__m256i const *>(l.shift) + 0)),
+					_mm256_load_si256(reinterpret_cast<__m256i const *>(l.mask) + 0)
+				);
+				__m256i const hi = _mm256_and_si256(
+					_mm256_srlv_epi32(v, _mm256_load_si256(reinterpret_cast<__m256i const *>(l.shift) + 1)),
+					_mm256_load_si256(reinterpret_cast<__m256i const *>(l.mask) + 1)
+				);
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out) + 0, lo);
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out) + 1, hi);
+
+				/* Chunks are never 0, so only the trailing unused ones are */
+				uint32_t const zeros =
+					static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(lo, zero)))) |
+					static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(hi, zero)))) << 8;
+				out += 16 - __builtin_popcount(zeros);
+			}
+			return static_cast<uint64_t>(out - begin);
+		}
+
+		__attribute__((target("avx2,bmi2,popcnt")))
+		static uint64_t skip_bits_avx2(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t target, uint64_t &accum, uint64_t &ones)
+		{
+			return skip_bits_body(words, spans, n, target, accum, ones);
+		}
+
+		__attribute__((target("avx2,bmi2,popcnt")))
+		static uint64_t skip_ones_avx2(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t &counter, uint64_t &accum)
+		{
+			return skip_ones_body(words, spans, n, counter, accum);
+		}
+
+		static constexpr kernel AVX2 = {"avx2", decode_avx2, skip_bits_avx2, skip_ones_avx2};
+
+		/* All 16 chunk lanes fit in a single register */
+		__attribute__((target("avx512f,avx2,bmi2,popcnt")))
+		static uint64_t decode_avx512(uint32_t const *words, uint64_t n, uint32_t *out)
+		{
+			uint32_t *const begin = out;
+			for (uint32_t const *w = words; w != words + n; w++) {
+				layout const &l = layout_of(*w);
+				*out = l.lead | (*w & l.run_mask);
+				out += *out != 0;
+
+				__m512i const c = _mm512_and_si512(
+					_mm512_maskz_srlv_epi32(0xFFFF, _mm512_set1_epi32(static_cast<int>(*w)), _mm512_load_si512(l.shift)),
+					_mm512_load_si512(l.mask)
+				);
+				_mm512_storeu_si512(out, c);
+
+				/* Chunks are never 0, so only the trailing unused ones are */
+				out += __builtin_popcount(static_cast<uint32_t>(_mm512_test_epi32_mask(c, c)));
+			}
+			return static_cast<uint64_t>(out - begin);
+		}
+
+		__attribute__((target("avx512f,avx2,bmi2,popcnt")))
+		static uint64_t skip_bits_avx512(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t target, uint64_t &accum, uint64_t &ones)
+		{
+			return skip_bits_body(words, spans, n, target, accum, ones);
+		}
+
+		__attribute__((target("avx512f,avx2,bmi2,popcnt")))
+		static uint64_t skip_ones_avx512(uint32_t const *words, uint8_t const *spans, uint64_t n, uint64_t &counter, uint64_t &accum)
+		{
+			return skip_ones_body(words, spans, n, counter, accum);
+		}
+
+		static constexpr kernel AVX512 = {"avx512f", decode_avx512, skip_bits_avx512, skip_ones_avx512};
+#endif
+};
+
+} /* namespace s18 */
+} /* namespace sdsl */
+
+#endif
@@ -20,13 +20,24 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <fstream>
+#include <functional>
 #include <iterator>
+#include <numeric>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <sdsl/int_vector.hpp>
 #include <sdsl/vlc_vector.hpp>
 #include <sdsl/util.hpp>
 
 #include "constants.hpp"
+#include "decoder.hpp"
+#include "storage.hpp"
+#include "summary.hpp"
 
 
 namespace sdsl
@@ -39,24 +50,59 @@ namespace s18
  */
 
 /* Access */
-template<uint16_t b_s = 256, class vector_type = int_vector<32>>
+template<uint16_t b_s = 256, class vector_type = int_vector<32>, class summary_type = no_summary>
 class access_support;
 
 /* Rank */
-template<uint8_t q = 1, uint16_t b_s = 256, class vector_type = int_vector<32>>
+template<uint8_t q = 1, uint16_t b_s = 256, class vector_type = int_vector<32>, class summary_type = no_summary>
 class rank_support;
 
 /* Select */
-template<uint8_t q = 1, uint16_t b_s = 256, class vector_type = int_vector<32>>
+template<uint8_t q = 1, uint16_t b_s = 256, class vector_type = int_vector<32>, class summary_type = no_summary>
 class select_support;
 
+/* Successor */
+template<uint16_t b_s = 256, class vector_type = int_vector<32>, class summary_type = no_summary>
+class successor_support;
+
+/* Predecessor */
+template<uint16_t b_s = 256, class vector_type = int_vector<32>, class summary_type = no_summary>
+class predecessor_support;
+
+/* Cursor for increasing queries */
+template<uint16_t b_s = 256, class vector_type = int_vector<32>, class summary_type = no_summary>
+class cursor;
+
 /* S18 word */
 class word;
 
 /* S18 vector */
-template<uint16_t b_s = 256, class vector_type = int_vector<32>>
+template<uint16_t b_s = 256, class vector_type = int_vector<32>, class summary_type = no_summary>
 class vector;
 
+/* S18 builder */
+template<uint16_t b_s = 256, class vector_type = int_vector<32>, class summary_type = no_summary>
+class builder;
+
+/* S18 vector with a header before every block */
+template<uint16_t b_s = 256, class summary_type = no_summary>
+class blocked_vector;
+
+/*
+ * S18 vector viewing a file written by serialize(), read only. Words and
+ * block samples stay in the file; a byte_summary is copied onto the heap.
+ * It is constructed from a file or a mapping, never built.
+ */
+template<uint16_t b_s = 256, class summary_type = no_summary>
+using mapped_vector = vector<b_s, mapped_words, summary_type>;
+
+/* How gaps are split into words */
+enum class packing
+{
+	greedy,  // Fill each word until the next gap does not fit
+	optimal  // Fewest words, chosen over windows of gaps
+};
+
 
 /*
  * S18 word
@@ -67,7 +113,8 @@ class word
 		bool                  already_packed;
 		bool                  processing_lead_1s;
 		uint64_t              leading_1s;
-		std::vector<uint32_t> pending_gaps;
+		uint32_t              pending_gaps[28];  // At most 28 chunks fit in a word
+		uint64_t              pending_size;
 
 		static uint64_t const BIT_PAD[33];
 		static uint64_t const BITS_TO_CHUNKS[29];
@@ -78,11 +125,19 @@ class word
 	public:
 		uint32_t value;
 		uint64_t chunk_size;
+
+		/* Chunk width needed to store gap */
+		static uint64_t chunk_bits(uint32_t const gap)
+		{
+			return BIT_PAD[bits::hi(gap) + 1];
+		}
+
 		word(void)
 			: already_packed(false)
 			, processing_lead_1s(true)
 			, leading_1s(0)
 			, pending_gaps()
+			, pending_size(0)
 			, value(0)
 			, chunk_size(1)
 		{}
@@ -92,6 +147,7 @@ class word
 			, processing_lead_1s(false)
 			, leading_1s(0)
 			, pending_gaps()
+			, pending_size(0)
 			, value(w)
 			, chunk_size(0)
 		{}
@@ -99,29 +155,9 @@ class word
 	public:
 		std::tuple<uint64_t, uint64_t, uint64_t> metadata(void) const
 		{
-			// Return leading 1s, case as int and len w/o leading ones
-			switch (value & MASK_HEADER4) {
-				case CASE01: return std::make_tuple(0,  0, CHUNKS_CASE01);
-				case CASE02: return std::make_tuple(1,  0, CHUNKS_CASE02);
-				case CASE03: return std::make_tuple(2,  0, CHUNKS_CASE03);
-				case CASE04: return std::make_tuple(3,  0, CHUNKS_CASE04);
-				case CASE05: return std::make_tuple(4,  0, CHUNKS_CASE05);
-				case CASE06: return std::make_tuple(5,  0, CHUNKS_CASE06);
-				case CASE07: return std::make_tuple(6,  0, CHUNKS_CASE07);
-				case CASE08: return std::make_tuple(0, 28, CHUNKS_CASE01);
-				case CASE09: return std::make_tuple(1, 28, CHUNKS_CASE02);
-				case CASE10: return std::make_tuple(2, 28, CHUNKS_CASE03);
-				case CASE11: return std::make_tuple(3, 28, CHUNKS_CASE04);
-				case CASE12: return std::make_tuple(4, 28, CHUNKS_CASE05);
-				case CASE13: return std::make_tuple(5, 28, CHUNKS_CASE06);
-				case CASE14: return std::make_tuple(6, 28, CHUNKS_CASE07);
-				case CASE15: return std::make_tuple(16, 28, CHUNKS_CASE17);
-				default: switch (value & MASK_HEADER5) {
-					case CASE16: return std::make_tuple(15, (value & MASK_BODY5), 0);
-					case CASE17: return std::make_tuple(16, 0, CHUNKS_CASE17);
-					default: throw std::invalid_argument("word::metadata: Invalid case");
-				}
-			}
+			// Return case as int, leading 1s and len w/o leading ones
+			decoder::descriptor const &d = decoder::describe(value);
+			return std::make_tuple(d.id, d.leading + (value & d.run_mask), d.chunks);
 		}
 
 		uint64_t access_fast(uint64_t key, uint64_t _case) const
@@ -136,27 +172,37 @@ class word
 			processing_lead_1s = processing_lead_1s and gap == 1;
 
 			if (processing_lead_1s) {
-				if (leading_1s < 0x07FFFFFF) leading_1s += 1;
-				return leading_1s < 0x07FFFFFF;
+				if (leading_1s == MASK_BODY5) return false;
+				leading_1s += 1;
+				return true;
 			}
 
-			if (leading_1s < 28) while (leading_1s) {
-				pending_gaps.push_back(1);
-				leading_1s--;
+			if (leading_1s > 28) return false;
+			if (leading_1s and leading_1s < 28) {
+				std::fill_n(pending_gaps, leading_1s, 1);
+				pending_size = leading_1s;
+				leading_1s = 0;
 			}
-			else if (leading_1s > 28) return false;
 
-			uint64_t new_pending_size = pending_gaps.size() + 1;
+			uint64_t new_pending_size = pending_size + 1;
 			uint64_t gap_size = BIT_PAD[bits::hi(gap) + 1];
 			uint64_t new_chunk_size = std::max(gap_size, chunk_size);
 			if (new_pending_size * new_chunk_size > 28)
 				return false;
 
-			pending_gaps.push_back(gap);
-			chunk_size = std::max(gap_size, chunk_size);
+			pending_gaps[pending_size++] = gap;
+			chunk_size = new_chunk_size;
 			return true;
 		}
 
+		/* Take further 1s as chunks after exactly 28 leading 1s */
+		void close_leading_1s(void)
+		{
+			assert(processing_lead_1s and leading_1s == 28);
+			processing_lead_1s = false;
+			chunk_size = 2;
+		}
+
 		uint32_t pack(void)
 		{
 			assert(not already_packed);
@@ -165,15 +211,15 @@ class word
 			/* Handler for C16 */
 			if (chunk_size == 1 and leading_1s)
 				return (value = CASE16 | static_cast<uint32_t>(leading_1s));
-			if (chunk_size == 1 and pending_gaps.size())
-				return (value = CASE16 | static_cast<uint32_t>(pending_gaps.size()));
+			if (chunk_size == 1 and pending_size)
+				return (value = CASE16 | static_cast<uint32_t>(pending_size));
 
-			for (uint32_t gap : pending_gaps) {
+			for (uint64_t i = 0; i < pending_size; i++) {
 				value <<= chunk_size;
-				value |= gap;
+				value |= pending_gaps[i];
 			}
-			value <<= chunk_size * (BITS_TO_CHUNKS[chunk_size] - pending_gaps.size());
-			pending_gaps.clear();
+			value <<= chunk_size * (BITS_TO_CHUNKS[chunk_size] - pending_size);
+			pending_size = 0;
 
 			switch (chunk_size) {
 				case 28: value |= !leading_1s ? CASE01 : CASE08; break;
@@ -192,63 +238,26 @@ class word
 
 #if DEBUG
 		uint64_t size(void) const {
-			switch (value & MASK_HEADER4) {
-				case CASE01: return CHUNKS_CASE01;
-				case CASE02: return CHUNKS_CASE02;
-				case CASE03: return CHUNKS_CASE03;
-				case CASE04: return CHUNKS_CASE04;
-				case CASE05: return CHUNKS_CASE05;
-				case CASE06: return CHUNKS_CASE06;
-				case CASE07: return CHUNKS_CASE07;
-				case CASE08: return CHUNKS_CASE08 + 28;
-				case CASE09: return CHUNKS_CASE09 + 28;
-				case CASE10: return CHUNKS_CASE10 + 28;
-				case CASE11: return CHUNKS_CASE11 + 28;
-				case CASE12: return CHUNKS_CASE12 + 28;
-				case CASE13: return CHUNKS_CASE13 + 28;
-				case CASE14: return CHUNKS_CASE14 + 28;
-				case CASE15: return CHUNKS_CASE15 + 28;
-				default: switch (value & MASK_HEADER5) {
-					case CASE16: return value & MASK_BODY5;
-					case CASE17: return CHUNKS_CASE17;
-					default: throw std::invalid_argument("word::size: Invalid case");
-				}
-			}
+			decoder::descriptor const &d = decoder::describe(value);
+			return d.leading + (value & d.run_mask) + d.chunks;
 		}
 
 		uint64_t operator[](uint64_t key) const
 		{
-			switch (value & MASK_HEADER4) {
-				case CASE01: return (value & (MASK_CASE01_CHUNK >> (key * BITS_CASE01))) >> (BITS_CASE01 * (CHUNKS_CASE01 - key - 1));
-				case CASE02: return (value & (MASK_CASE02_CHUNK >> (key * BITS_CASE02))) >> (BITS_CASE02 * (CHUNKS_CASE02 - key - 1));
-				case CASE03: return (value & (MASK_CASE03_CHUNK >> (key * BITS_CASE03))) >> (BITS_CASE03 * (CHUNKS_CASE03 - key - 1));
-				case CASE04: return (value & (MASK_CASE04_CHUNK >> (key * BITS_CASE04))) >> (BITS_CASE04 * (CHUNKS_CASE04 - key - 1));
-				case CASE05: return (value & (MASK_CASE05_CHUNK >> (key * BITS_CASE05))) >> (BITS_CASE05 * (CHUNKS_CASE05 - key - 1));
-				case CASE06: return (value & (MASK_CASE06_CHUNK >> (key * BITS_CASE06))) >> (BITS_CASE06 * (CHUNKS_CASE06 - key - 1));
-				case CASE07: return (value & (MASK_CASE07_CHUNK >> (key * BITS_CASE07))) >> (BITS_CASE07 * (CHUNKS_CASE07 - key - 1));
-				case CASE08: return key < 28 ? 1 : (value & (MASK_CASE08_CHUNK >> ((key - 28) * BITS_CASE08))) >> (BITS_CASE08 * (CHUNKS_CASE08 - (key - 28) - 1));
-				case CASE09: return key < 28 ? 1 : (value & (MASK_CASE09_CHUNK >> ((key - 28) * BITS_CASE09))) >> (BITS_CASE09 * (CHUNKS_CASE09 - (key - 28) - 1));
-				case CASE10: return key < 28 ? 1 : (value & (MASK_CASE10_CHUNK >> ((key - 28) * BITS_CASE10))) >> (BITS_CASE10 * (CHUNKS_CASE10 - (key - 28) - 1));
-				case CASE11: return key < 28 ? 1 : (value & (MASK_CASE11_CHUNK >> ((key - 28) * BITS_CASE11))) >> (BITS_CASE11 * (CHUNKS_CASE11 - (key - 28) - 1));
-				case CASE12: return key < 28 ? 1 : (value & (MASK_CASE12_CHUNK >> ((key - 28) * BITS_CASE12))) >> (BITS_CASE12 * (CHUNKS_CASE12 - (key - 28) - 1));
-				case CASE13: return key < 28 ? 1 : (value & (MASK_CASE13_CHUNK >> ((key - 28) * BITS_CASE13))) >> (BITS_CASE13 * (CHUNKS_CASE13 - (key - 28) - 1));
-				case CASE14: return key < 28 ? 1 : (value & (MASK_CASE14_CHUNK >> ((key - 28) * BITS_CASE14))) >> (BITS_CASE14 * (CHUNKS_CASE14 - (key - 28) - 1));
-				case CASE15: return key < 28 ? 1 : (value & (MASK_CASE15_CHUNK >> ((key - 28) * BITS_CASE15))) >> (BITS_CASE15 * (CHUNKS_CASE15 - (key - 28) - 1));
-				default: switch (value & MASK_HEADER5) {
-					case CASE16: return key < (value & MASK_CASE16_CHUNK);
-					case CASE17: return (value & (MASK_CASE17_CHUNK >> (key * BITS_CASE17))) >> (BITS_CASE17 * (CHUNKS_CASE17 - key - 1));
-					default: throw std::invalid_argument("word::operator[]: Invalid case");
-				}
-			}
+			decoder::descriptor const &d = decoder::describe(value);
+			uint64_t const lead = d.leading + (value & d.run_mask);
+			if (key < lead) return 1;
+			if (key - lead >= d.chunks) return 0;
+			return access_fast(key - lead, d.id);
 		}
 #endif
 };
 
-uint64_t const word::BIT_PAD[33] = { 1, 1, 2, 3, 4, 5, 7, 7, 9, 9, 14, 14, 14, 14, 14, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28 };
-uint64_t const word::BITS_TO_CHUNKS[29] = { 0,28,14,9,7,5,0,4,0,3,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,1};
-uint64_t const word::DECODER_CHUNKS[17] = {1,2,3,4,7,9,14,1,2,3,4,7,9,14,5,0,5};
-uint64_t const word::DECODER_BITS[17] = {28,14,9,7,4,3,2,28,14,9,7,4,3,2,5,0,5};
-uint32_t const word::DECODER_MASK[17][14] = {
+inline uint64_t const word::BIT_PAD[33] = { 1, 1, 2, 3, 4, 5, 7, 7, 9, 9, 14, 14, 14, 14, 14, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28 };
+inline uint64_t const word::BITS_TO_CHUNKS[29] = { 0,28,14,9,7,5,0,4,0,3,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,1};
+inline uint64_t const word::DECODER_CHUNKS[17] = {1,2,3,4,7,9,14,1,2,3,4,7,9,14,5,0,5};
+inline uint64_t const word::DECODER_BITS[17] = {28,14,9,7,4,3,2,28,14,9,7,4,3,2,5,0,5};
+inline uint32_t const word::DECODER_MASK[17][14] = {
 	{MASK_CASE01_CHUNK >> (0 * BITS_CASE01)},
 	{MASK_CASE02_CHUNK >> (0 * BITS_CASE02), MASK_CASE02_CHUNK >> (1 * BITS_CASE02)},
 	{MASK_CASE03_CHUNK >> (0 * BITS_CASE03), MASK_CASE03_CHUNK >> (1 * BITS_CASE03), MASK_CASE03_CHUNK >> (2 * BITS_CASE03)},
@@ -267,7 +276,7 @@ uint32_t const word::DECODER_MASK[17][14] = {
 	{},
 	{MASK_CASE17_CHUNK >> (0 * BITS_CASE17), MASK_CASE17_CHUNK >> (1 * BITS_CASE17), MASK_CASE17_CHUNK >> (2 * BITS_CASE17), MASK_CASE17_CHUNK >> (3 * BITS_CASE17), MASK_CASE17_CHUNK >> (4 * BITS_CASE17)}
 };
-uint32_t const word::DECODER_SHIFT[17][14] = {
+inline uint32_t const word::DECODER_SHIFT[17][14] = {
 	{0},
 	{14,0},
 	{18,9,0},
@@ -291,35 +300,58 @@ uint32_t const word::DECODER_SHIFT[17][14] = {
 /*
  * S18 Vector
  */
-template<uint16_t b_s, class vector_type>
+template<uint16_t b_s, class vector_type, class summary_type>
 class vector
 {
 	public:
-		friend class access_support<b_s>;
-		friend class rank_support<0, b_s>;
-		friend class rank_support<1, b_s>;
-		friend class select_support<0, b_s>;
-		friend class select_support<1, b_s>;
+		friend class access_support<b_s, vector_type, summary_type>;
+		friend class rank_support<0, b_s, vector_type, summary_type>;
+		friend class rank_support<1, b_s, vector_type, summary_type>;
+		friend class select_support<0, b_s, vector_type, summary_type>;
+		friend class select_support<1, b_s, vector_type, summary_type>;
+		friend class successor_support<b_s, vector_type, summary_type>;
+		friend class predecessor_support<b_s, vector_type, summary_type>;
+		friend class cursor<b_s, vector_type, summary_type>;
+		friend class builder<b_s, vector_type, summary_type>;
+		template<uint16_t, class> friend class blocked_vector;
 
 		typedef typename vector_type::iterator       iterator_type;
 		typedef typename vector_type::const_iterator const_iterator_type;
 		typedef typename vector_type::size_type      size_type;
+		typedef typename storage<vector_type>::words   words_type;
+		typedef typename storage<vector_type>::samples samples_type;
+
+		static_assert(
+			std::is_same<decltype(std::declval<words_type const &>().begin()), uint32_t const *>::value,
+			"vector: words must be stored contiguously and scanned through uint32_t pointers"
+		);
 
 	private:
 		uint64_t       m_ones;        // 1 bits in original sequence
 		uint64_t       m_size;        // Lenth of original bit vector
 		uint64_t       s18_seq_size;  // Count of S18 words
-		int_vector<32> s18_seq;       // Vector of S18 words
-		int_vector<>   idx_bits;      // Total bits before block
-		int_vector<>   idx_ones;      // Total 1 bits before block
-		int_vector<>   l2_bits;
-		int_vector<>   l2_ones;
+		words_type     s18_seq;       // Vector of S18 words
+		samples_type   idx_bits;      // Total bits before block
+		samples_type   idx_ones;      // Total 1 bits before block
+		samples_type   l2_bits;
+		samples_type   l2_ones;
+		samples_type   l2_zeros;      // Last block with fewer 0 bits before it than the sample
 		uint64_t       l2_bits_div;
 		uint64_t       l2_ones_div;
+		uint64_t       l2_zeros_div;
+		summary_type   m_summary;     // Per word ones and spans
+
+		static uint64_t constexpr RANGE_BATCH = 16;  // Words decoded at once by decode_range()
+		static uint64_t constexpr PREFETCH_WORDS = 64;  // Block words fetched ahead by interleave()
+		static uint64_t constexpr NEAR_BLOCKS = 4;      // Blocks a finger walks before looking the key up
 
 	public:
-		/* Default constructor */
-		vector(void)=delete;
+		/* Default constructor, an empty vector to load() into */
+		vector(void)
+			: vector(builder<b_s, vector_type, summary_type>().build())
+		{
+			static_assert(not storage<vector_type>::mapped, "vector::vector: a mapped_vector is constructed from a file");
+		} /* end vector::vector */
 
 		/* Copy constructor */
 		vector(vector const &other) /* copy */
@@ -331,83 +363,95 @@ class vector
 			, idx_ones(other.idx_ones)
 			, l2_bits(other.l2_bits)
 			, l2_ones(other.l2_ones)
+			, l2_zeros(other.l2_zeros)
 			, l2_bits_div(other.l2_bits_div)
 			, l2_ones_div(other.l2_ones_div)
+			, l2_zeros_div(other.l2_zeros_div)
+			, m_summary(other.m_summary)
 		{} /* end vector::vector */
 
 		/* Move constructor */
-		vector(vector const &&other) /* move */
-		{
-			*this = std::move(other);
-		} /* end vector::vector */
+		vector(vector &&other) /* move */
+			: m_ones(other.m_ones)
+			, m_size(other.m_size)
+			, s18_seq_size(other.s18_seq_size)
+			, s18_seq(std::move(other.s18_seq))
+			, idx_bits(std::move(other.idx_bits))
+			, idx_ones(std::move(other.idx_ones))
+			, l2_bits(std::move(other.l2_bits))
+			, l2_ones(std::move(other.l2_ones))
+			, l2_zeros(std::move(other.l2_zeros))
+			, l2_bits_div(other.l2_bits_div)
+			, l2_ones_div(other.l2_ones_div)
+			, l2_zeros_div(other.l2_zeros_div)
+			, m_summary(std::move(other.m_summary))
+		{} /* end vector::vector */
 
-		/* Constructor from bitvector */
+		/* Constructor from bitvector, streams its 1 bits through a builder */
 		vector(bit_vector const &bv)
-			: m_ones(util::cnt_one_bits(bv))
-			, m_size(bv.size())
+			: vector(encode(bv))
+		{} /* end vector::vector */
+
+		/* Constructor from bitvector, splitting its gaps into words as `p` says */
+		vector(bit_vector const &bv, packing const p)
+			: vector(encode(bv, p))
+		{} /* end vector::vector */
+
+		/* Constructor from bitvector, packing segments of it in `threads` threads */
+		vector(bit_vector const &bv, uint64_t const threads)
+			: vector(threads > 1 ? encode(bv, threads) : encode(bv))
+		{} /* end vector::vector */
+
+		/*
+		 * Constructor from a file written by serialize(). A mapped_vector
+		 * views the file in place but for its summary, which is loaded;
+		 * any other vector loads all of it.
+		 */
+		explicit vector(std::string const &file)
+			: m_ones(0)
+			, m_size(0)
 			, s18_seq_size(0)
-			, s18_seq(m_ones, 0)
-			, idx_bits(m_ones / b_s + 2, 0)
-			, idx_ones(m_ones / b_s + 2, 0)
-			, l2_bits(0, 0)
-			, l2_ones(0, 0)
+			, s18_seq()
+			, idx_bits()
+			, idx_ones()
+			, l2_bits()
+			, l2_ones()
+			, l2_zeros()
 			, l2_bits_div(1)
 			, l2_ones_div(1)
+			, l2_zeros_div(1)
+			, m_summary()
 		{
-			/* Get absolute positions */
-			int_vector<64> absp = int_vector<64>(m_ones, 0);
-			for (uint64_t i = 0, j = 0; i < m_size; i++)
-				if (bv[i]) absp[j++] = i;
-
-			/* Get gaps from absolute positions */
-			int_vector<32> gaps = int_vector<32>(m_ones, 0);
-			for (uint64_t i = 1; i < m_ones; i++)
-				gaps[i] = static_cast<uint32_t>(absp[i] - absp[i - 1]);
-			gaps[0] = static_cast<uint32_t>(absp[0]) + 1;
-
-			/* Indexes indices */
-			uint64_t size_idx_bits = 1;
-			uint64_t size_idx_ones = 1;
-
-			/* Encode gaps into s18 words */
-			int_vector<32>::const_iterator gap = gaps.begin();
-			int_vector<32>::const_iterator const begin = gaps.begin();
-			int_vector<32>::const_iterator const end = gaps.end();
-			while (std::distance(gap, end) > 0) {
-				for (uint64_t i = 0; i < b_s; i++)
-					gap = pack_word(gap, end);
-
-				uint64_t gaps_encoded = std::distance(begin, gap);
-				idx_bits[size_idx_bits++] = absp[gaps_encoded - 1] + 1;
-				idx_ones[size_idx_ones++] = gaps_encoded;
-			}
-
-			/* Get rid of extra unused space */
-			s18_seq.resize(s18_seq_size);
-			idx_bits.resize(size_idx_bits);
-			idx_ones.resize(size_idx_ones);
-
-			/* Build L2 index */
-			uint64_t size_l2 = size_idx_bits;
-			l2_bits.resize(size_l2);
-			l2_ones.resize(size_l2);
-
-			l2_bits_div = m_size / size_l2 + (m_size % size_l2 != 0);
-			for (uint64_t i = 0; i < size_l2; i++) {
-				auto it = std::upper_bound(idx_bits.begin(), idx_bits.end(), i * l2_bits_div);
-				l2_bits[i] = std::distance(idx_bits.begin(), it);
-			}
-
-			l2_ones_div = (m_ones + 1) / size_l2 + ((m_ones + 1) % size_l2 != 0);
-			for (uint64_t i = 0; i < size_l2; i++) {
-				auto it = std::upper_bound(idx_ones.begin(), idx_ones.end(), i * l2_ones_div);
-				l2_ones[i] = std::distance(idx_ones.begin(), it);
+			if constexpr (storage<vector_type>::mapped) {
+				map(std::make_shared<mapping const>(file), 0);
+			} else {
+				std::ifstream in(file, std::ios::binary);
+				if (not in)
+					throw std::invalid_argument("vector::vector: cannot open " + file);
+				load(in);
+				if (not in)
+					throw std::invalid_argument("vector::vector: " + file + " is truncated or was serialized by another vector_type");
 			}
+		} /* end vector::vector */
 
-			util::bit_compress(idx_bits);
-			util::bit_compress(idx_ones);
-			util::bit_compress(l2_bits);
-			util::bit_compress(l2_ones);
+		/* Constructor viewing what serialize() wrote at `offset` of m, for a mapped_vector */
+		vector(std::shared_ptr<mapping const> m, uint64_t const offset)
+			: m_ones(0)
+			, m_size(0)
+			, s18_seq_size(0)
+			, s18_seq()
+			, idx_bits()
+			, idx_ones()
+			, l2_bits()
+			, l2_ones()
+			, l2_zeros()
+			, l2_bits_div(1)
+			, l2_ones_div(1)
+			, l2_zeros_div(1)
+			, m_summary()
+		{
+			static_assert(storage<vector_type>::mapped, "vector::vector: only a mapped_vector views a mapping");
+			map(std::move(m), offset);
 		} /* end vector::vector */
 
 		uint64_t size(void) const
@@ -415,6 +459,12 @@ class vector
 			return m_size;
 		}
 
+		/* Number of 1 bits */
+		uint64_t ones(void) const
+		{
+			return m_ones;
+		}
+
 		uint64_t slow_access(uint64_t const key) const
 		{
 			return find_block_nth(
@@ -426,15 +476,38 @@ class vector
 
 		uint64_t operator[](uint64_t const key) const
 		{
-			uint64_t pos = l2_bits[key / l2_bits_div] - 1;
+			uint64_t pos = block_by_bits(key);
 			return find_block_nth(
-				s18_seq.begin() + pos * b_s,
-				s18_seq.end(),
+				block_begin(pos),
+				block_end(pos),
 				key - idx_bits[pos]
 			);
 		}
 
-		int_vector<32> const &data(void) const
+		/*
+		 * out[i] = (*this)[keys[i]] for n keys. Keys falling in the same
+		 * block are answered by resuming the scan of the previous one.
+		 */
+		void access_batch(uint64_t const *keys, uint64_t const n, uint64_t *out) const
+		{
+			batch(keys, n, out, [this](finger &f, uint64_t const key) {
+				return finger_access(f, key);
+			});
+		}
+
+		/*
+		 * out[i] = (*this)[keys[i]] for n keys in any order, G of them in
+		 * flight at once to overlap their cache misses
+		 */
+		template<uint64_t G = 16>
+		void access_interleaved(uint64_t const *keys, uint64_t const n, uint64_t *out) const
+		{
+			interleave<G, false>(keys, n, out, [this](uint64_t const pos, uint64_t const key) {
+				return find_block_nth(block_begin(pos), block_end(pos), key - idx_bits[pos]);
+			});
+		}
+
+		words_type const &data(void) const
 		{
 			return s18_seq;
 		}
@@ -449,203 +522,2049 @@ class vector
 			written_bytes += write_member(s18_seq_size, out, child, "s18_seq_size");
 			written_bytes += write_member(l2_bits_div, out, child, "l2_bits_div");
 			written_bytes += write_member(l2_ones_div, out, child, "l2_ones_div");
+			written_bytes += write_member(l2_zeros_div, out, child, "l2_zeros_div");
+			written_bytes += write_member(storage<vector_type>::LAYOUT, out, child, "m_layout");
 
 			written_bytes += s18_seq.serialize(out, child, "s18_seq");
-			written_bytes += idx_bits.serialize(out, child, "idx_bits");
-			written_bytes += idx_ones.serialize(out, child, "idx_ones");
+			written_bytes += storage<vector_type>::serialize_blocks(idx_bits, idx_ones, out, child);
 			written_bytes += l2_bits.serialize(out, child, "l2_bits");
 			written_bytes += l2_ones.serialize(out, child, "l2_ones");
+			written_bytes += l2_zeros.serialize(out, child, "l2_zeros");
+			written_bytes += m_summary.serialize(out, child, "m_summary");
 
 			structure_tree::add_size(child, written_bytes);
 
 			return written_bytes;
 		}
 
-	private:
-		uint64_t find_block_nth(int_vector<32>::const_iterator const begin, int_vector<32>::const_iterator const end, uint64_t target_accum) const
+		/* Read back what serialize() wrote, failing `in` if its samples are laid out for another vector_type */
+		void load(std::istream &in)
 		{
-			int_vector<32>::const_iterator gaps = begin;
-			uint64_t accum = -1;
+			uint64_t layout = 0;
+			read_member(m_ones, in);
+			read_member(m_size, in);
+			read_member(s18_seq_size, in);
+			read_member(l2_bits_div, in);
+			read_member(l2_ones_div, in);
+			read_member(l2_zeros_div, in);
+			read_member(layout, in);
+			if (layout != storage<vector_type>::LAYOUT) {
+				in.setstate(std::ios::failbit);
+				return;
+			}
+
+			s18_seq.load(in);
+			storage<vector_type>::load_blocks(idx_bits, idx_ones, in);
+			l2_bits.load(in);
+			l2_ones.load(in);
+			l2_zeros.load(in);
+			m_summary.load(in);
+		}
+
+		/*
+		 * Forward iterator over the positions of the 1 bits
+		 *
+		 * Words are decoded one chunk at a time while walking, so a full
+		 * traversal costs O(1) per 1 bit. skip_to() jumps through the block
+		 * samples and skips whole words by their span before stepping.
+		 */
+		class const_one_iterator
+		{
+			public:
+				typedef std::forward_iterator_tag iterator_category;
+				typedef uint64_t                  value_type;
+				typedef std::ptrdiff_t            difference_type;
+				typedef uint64_t const           *pointer;
+				typedef uint64_t                  reference;
+
+			private:
+				vector const *v;
+				uint64_t      word_idx;   // Word being walked
+				uint64_t      word_last;  // Last 1 bit of that word
+				uint64_t      pos;        // Current 1 bit, size() at the end
+				uint64_t      lead_left;  // Leading 1s of the word not walked yet
+				uint32_t      value;
+				uint32_t      mask;
+				uint8_t       bits;
+				uint8_t       chunks_left;
+
+				/* Enter word i, pos being the last 1 bit before it */
+				void load(uint64_t const i)
+				{
+					word_idx = i;
+					value = v->s18_seq[i];
+					decoder::descriptor const &d = decoder::describe(value);
+					lead_left = d.leading + (value & d.run_mask);
+					bits = d.bits;
+					chunks_left = d.chunks;
+					mask = static_cast<uint32_t>((uint64_t(1) << d.bits) - 1);
+					word_last = pos + decoder::span(value);
+				}
+
+				void finish(void)
+				{
+					word_idx = v->s18_seq_size;
+					pos = v->m_size;
+					lead_left = 0;
+					chunks_left = 0;
+				}
 
-			for (; std::distance(gaps, end) > 0; gaps++) {
-				word w(*gaps);
-				auto const [_case, leading_1s, len] = w.metadata();
+				/* Step within the word to p, which is at most word_last */
+				const_one_iterator &step_to(uint64_t const p)
+				{
+					while (pos < p) {
+						if (lead_left) {
+							uint64_t const step = std::min(lead_left, p - pos);
+							lead_left -= step;
+							pos += step;
+							if (pos >= p) break;
+						}
+						++*this;
+					}
+					return *this;
+				}
 
-				if (leading_1s and (accum += leading_1s) >= target_accum)
-					return 1;
+			public:
+				const_one_iterator(void)
+					: v(nullptr), word_idx(0), word_last(0), pos(0), lead_left(0), value(0), mask(0), bits(0), chunks_left(0)
+				{}
+
+				/* Iterator at the first 1 bit of cv, or at its end */
+				const_one_iterator(vector const &cv, bool const at_end)
+					: v(&cv), word_idx(-1), word_last(-1), pos(-1), lead_left(0), value(0), mask(0), bits(0), chunks_left(0)
+				{
+					if (at_end) finish();
+					else ++*this;
+				}
 
-				for (uint64_t i = 0; i < len; i++) {
-					uint64_t wi = w.access_fast(i, _case);
-					if (wi == 0) break; /* Word was not full */
+				uint64_t operator*(void) const
+				{
+					return pos;
+				}
 
-					accum += wi;
-					if (accum == target_accum) return 1;
-					if (accum > target_accum) return 0;
+				const_one_iterator &operator++(void)
+				{
+					for (;;) {
+						if (lead_left) {
+							lead_left--;
+							pos++;
+							return *this;
+						}
+						while (chunks_left) {
+							chunks_left--;
+							uint32_t const gap = (value >> (bits * chunks_left)) & mask;
+							if (gap == 0) break; /* Word was not full */
+							pos += gap;
+							return *this;
+						}
+						chunks_left = 0;
+
+						if (word_idx + 1 >= v->s18_seq_size) {
+							finish();
+							return *this;
+						}
+						load(word_idx + 1);
+					}
 				}
-			}
 
-			return 0;
+				const_one_iterator operator++(int)
+				{
+					const_one_iterator it = *this;
+					++*this;
+					return it;
+				}
+
+				/* Move to the first 1 bit at or after p */
+				const_one_iterator &skip_to(uint64_t const p)
+				{
+					if (p <= pos) return *this;
+					if (p >= v->m_size) {
+						finish();
+						return *this;
+					}
+					if (p <= word_last) return step_to(p);
+
+					/* The block holding p ends with a 1 bit at or after it */
+					uint64_t blk = word_idx / b_s;
+					if (blk + 1 >= v->idx_bits.size() or v->idx_bits[blk + 1] <= p) {
+						/* Not the current block */
+						blk = v->block_by_bits(p);
+						if (blk * b_s >= v->s18_seq_size) {
+							/* p lies past the last 1 bit */
+							finish();
+							return *this;
+						}
+						if (word_idx < blk * b_s) {
+							word_idx = blk * b_s - 1;
+							word_last = v->idx_bits[blk] - 1;
+							lead_left = 0;
+							chunks_left = 0;
+						}
+					}
+					uint64_t const first = blk * b_s;
+
+					if (word_last < p) {
+						/* Skip words ending before p */
+						uint64_t const next = word_idx + 1;
+						uint64_t const stop = std::min<uint64_t>(first + b_s, v->s18_seq_size);
+						uint64_t accum = 0;
+						uint64_t ones = 0;
+						uint64_t const skipped = v->m_summary.skip_bits(
+							v->s18_seq.begin() + next,
+							next,
+							stop - next,
+							p - word_last,
+							accum,
+							ones
+						);
+						if (next + skipped == stop) {
+							finish();
+							return *this;
+						}
+						pos = word_last + accum;
+						load(next + skipped);
+					}
+
+					return step_to(p);
+				}
+
+				bool operator==(const_one_iterator const &other) const
+				{
+					return pos == other.pos;
+				}
+
+				bool operator!=(const_one_iterator const &other) const
+				{
+					return pos != other.pos;
+				}
+		};
+
+		const_one_iterator begin_ones(void) const
+		{
+			return const_one_iterator(*this, false);
 		}
 
-		inline int_vector<32>::const_iterator pack_word(int_vector<32>::const_iterator const begin, int_vector<32>::const_iterator const end)
+		const_one_iterator end_ones(void) const
 		{
-			/* Early return */
-			if (std::distance(begin, end) <= 0)
-				return begin;
+			return const_one_iterator(*this, true);
+		}
 
-			/* Pointer to gaps */
-			int_vector<32>::const_iterator gaps = begin;
+		/*
+		 * Write the position of every 1 bit in [a, b) to out, in order.
+		 * The block holding a is located once, words before a are skipped
+		 * by their span and the rest are decoded in batches with the active
+		 * kernel until b is passed.
+		 */
+		template<class output_iterator>
+		output_iterator decode_range(uint64_t const a, uint64_t b, output_iterator out) const
+		{
+			b = std::min(b, m_size);
+			if (a >= b) return out;
 
-			/* Create and pack word */
-			word w = word();
-			while (std::distance(gaps, end) > 0 and w.add_if_enough_space(*gaps)) gaps++;
-			s18_seq[s18_seq_size++] = w.pack();
+			uint64_t const pos = block_by_bits(a);
+			uint32_t const *const begin = block_begin(pos);
+			uint64_t accum = -1;
+			uint64_t ones = 0;
+			uint32_t const *w = begin + m_summary.skip_bits(
+				begin,
+				static_cast<uint64_t>(begin - s18_seq.begin()),
+				static_cast<uint64_t>(block_end(pos) - begin),
+				a - idx_bits[pos],
+				accum,
+				ones
+			);
 
-			/* Return iterator to the very next compressable gap */
-			return gaps;
+			/* Last 1 bit before w, -1 if there is none */
+			uint64_t last = idx_bits[pos] + accum;
+			uint32_t const *const end = s18_seq.begin() + s18_seq_size;
+			uint32_t gaps[RANGE_BATCH * decoder::MAX_WORD_GAPS + decoder::PADDING];
+			while (w < end) {
+				uint64_t const words = std::min<uint64_t>(RANGE_BATCH, static_cast<uint64_t>(end - w));
+				uint64_t const n = decoder::decode(w, words, gaps);
+				w += words;
+
+				for (uint64_t i = 0; i < n; i++) {
+					if (gaps[i] & decoder::RUN) {
+						uint64_t const len = gaps[i] & ~decoder::RUN;
+						uint64_t const to = std::min(last + len + 1, b);
+						for (uint64_t p = std::max(last + 1, a); p < to; p++)
+							*out++ = p;
+						last += len;
+						if (last + 1 >= b) return out;
+						continue;
+					}
+
+					last += gaps[i];
+					if (last >= b) return out;
+					if (last >= a) *out++ = last;
+				}
+			}
+			return out;
 		}
-};
 
+		/* Same as above into an array, which must fit them; returns how many were written */
+		uint64_t decode_range(uint64_t const a, uint64_t const b, uint64_t *const out) const
+		{
+			return static_cast<uint64_t>(decode_range<uint64_t *>(a, b, out) - out);
+		}
 
-template<uint16_t b_s, class vector_type>
-class access_support
-{
 	private:
-		vector<b_s, vector_type> const &bv;
-	public:
-		access_support(void)=delete;
-		access_support(vector<b_s, vector_type> &cv)
-			: bv(cv)
-		{}
-		uint64_t operator()(uint64_t const key) const { return bv[key]; }
+		/* Point at what serialize() wrote to a mapped file, in the same order */
+		void map(std::shared_ptr<mapping const> m, uint64_t const offset)
+		{
+			mapped_reader r(std::move(m), offset);
+			r.member(m_ones);
+			r.member(m_size);
+			r.member(s18_seq_size);
+			r.member(l2_bits_div);
+			r.member(l2_ones_div);
+			r.member(l2_zeros_div);
+			uint64_t layout = 0;
+			r.member(layout);
+			if (layout != storage<vector_type>::LAYOUT)
+				throw std::invalid_argument("vector::map: block samples are laid out for another vector_type");
+
+			r.words(s18_seq);
+			r.samples(idx_bits);
+			r.samples(idx_ones);
+			r.samples(l2_bits);
+			r.samples(l2_ones);
+			r.samples(l2_zeros);
+			r.load(m_summary);
+
+			if (s18_seq.size() != s18_seq_size or idx_bits.size() == 0 or idx_ones.size() != idx_bits.size())
+				throw std::invalid_argument("vector::map: file does not hold an S18 vector");
+		}
 
-};
+		/* Constructor from already encoded words, see builder */
+		vector(uint64_t const size, uint64_t const ones, int_vector<32> &&seq, uint64_t const seq_size, int_vector<> &&bits, int_vector<> &&ones_before)
+			: m_ones(ones)
+			, m_size(size)
+			, s18_seq_size(seq_size)
+			, s18_seq(storage<vector_type>::adopt(std::move(seq), seq_size))
+			, idx_bits()
+			, idx_ones()
+			, l2_bits()
+			, l2_ones()
+			, l2_zeros()
+			, l2_bits_div(1)
+			, l2_ones_div(1)
+			, l2_zeros_div(1)
+			, m_summary()
+		{
+			build_index(std::move(bits), std::move(ones_before));
+		} /* end vector::vector */
 
-template<uint8_t q, uint16_t b_s, class vector_type>
-class rank_support
-{
-	static_assert(q < 2, "rank_support: bit pattern must be `0` or `1`");
-	private:
-		vector<b_s, vector_type> const &bv;
+		/* Sample blocks by bits, by ones and by zeros, then store the samples */
+		void build_index(int_vector<> &&bits, int_vector<> &&ones_before)
+		{
+			/* Build L2 index */
+			uint64_t size_l2 = bits.size();
+			int_vector<> by_bits(size_l2, 0);
+			int_vector<> by_ones(size_l2, 0);
+			int_vector<> by_zeros(size_l2, 0);
 
-		typedef typename vector_type::iterator       iterator_type;
-		typedef typename vector_type::const_iterator const_iterator_type;
+			l2_bits_div = std::max<uint64_t>(m_size / size_l2 + (m_size % size_l2 != 0), 1);
+			for (uint64_t i = 0; i < size_l2; i++) {
+				auto it = std::upper_bound(bits.begin(), bits.end(), i * l2_bits_div);
+				by_bits[i] = std::distance(bits.begin(), it);
+			}
 
-	private:
-		uint64_t rank0(uint64_t const key) const
+			l2_ones_div = (m_ones + 1) / size_l2 + ((m_ones + 1) % size_l2 != 0);
+			for (uint64_t i = 0; i < size_l2; i++) {
+				auto it = std::upper_bound(ones_before.begin(), ones_before.end(), i * l2_ones_div);
+				by_ones[i] = std::distance(ones_before.begin(), it);
+			}
+
+			/* 0 bits before each block are its bits minus its ones */
+			std::vector<uint64_t> zeros(size_l2);
+			for (uint64_t i = 0; i < size_l2; i++)
+				zeros[i] = bits[i] - ones_before[i];
+			uint64_t const m_zeros = m_size - m_ones;
+			l2_zeros_div = std::max<uint64_t>((m_zeros + 1) / size_l2 + ((m_zeros + 1) % size_l2 != 0), 1);
+			for (uint64_t i = 0; i < size_l2; i++) {
+				auto it = std::lower_bound(zeros.begin(), zeros.end(), i * l2_zeros_div);
+				by_zeros[i] = std::max<uint64_t>(std::distance(zeros.begin(), it), 1) - 1;
+			}
+
+			storage<vector_type>::sampled_blocks(std::move(bits), std::move(ones_before), idx_bits, idx_ones);
+			l2_bits = storage<vector_type>::sampled(std::move(by_bits));
+			l2_ones = storage<vector_type>::sampled(std::move(by_ones));
+			l2_zeros = storage<vector_type>::sampled(std::move(by_zeros));
+
+			m_summary.build(s18_seq.begin(), s18_seq_size);
+		}
+
+		/* l2 sample for `key`, keys past the last sample (such as size()) taking the last one */
+		static uint64_t l2_index(samples_type const &l2, uint64_t const key, uint64_t const div)
 		{
-			return key - rank1(key);
+			return std::min<uint64_t>(key / div, l2.size() - 1);
 		}
 
-		uint64_t rank1(uint64_t const key) const
+		/* Last block starting at or before bit `key` */
+		uint64_t block_by_bits(uint64_t const key) const
 		{
-			uint64_t pos = bv.l2_bits[key / bv.l2_bits_div] - 1;
-			return bv.idx_ones[pos] + find_block_nth(
-				bv.s18_seq.begin() + pos * b_s,
-				bv.s18_seq.end(),
-				key - bv.idx_bits[pos]
-			);
+			uint64_t pos = l2_bits[l2_index(l2_bits, key, l2_bits_div)] - 1;
+			while (pos + 1 < idx_bits.size() and idx_bits[pos + 1] <= key) pos++;
+			return pos;
+		}
+
+		/* Block holding the `key`-th 1 bit */
+		uint64_t block_by_ones(uint64_t const key) const
+		{
+			uint64_t pos = l2_ones[l2_index(l2_ones, key, l2_ones_div)] - 1;
+			while (pos + 1 < idx_ones.size() and idx_ones[pos + 1] < key) pos++;
+			return pos;
+		}
+
+		/* Block holding the `key`-th 0 bit, or the one after the last block */
+		uint64_t block_by_zeros(uint64_t const key) const
+		{
+			uint64_t pos = l2_zeros[l2_index(l2_zeros, key, l2_zeros_div)];
+			while (pos + 1 < idx_bits.size() and idx_bits[pos + 1] - idx_ones[pos + 1] < key) pos++;
+			return pos;
+		}
+
+		uint32_t const *block_begin(uint64_t const pos) const
+		{
+			return s18_seq.begin() + std::min<uint64_t>(pos * b_s, s18_seq_size);
 		}
 
-		uint64_t find_block_nth(int_vector<32>::const_iterator const begin, int_vector<32>::const_iterator const end, uint64_t target_accum) const
+		uint32_t const *block_end(uint64_t const pos) const
+		{
+			return s18_seq.begin() + std::min<uint64_t>(pos * b_s + b_s, s18_seq_size);
+		}
+
+		uint64_t find_block_nth(uint32_t const *const begin, uint32_t const *const end, uint64_t target_accum) const
 		{
-			int_vector<32>::const_iterator gaps = begin;
 			uint64_t accum = -1;
 			uint64_t one_cnt = 0;
 
-			for (; std::distance(gaps, end) > 0; gaps++) {
-				word w(*gaps);
-				auto const [_case, leading_1s, len] = w.metadata();
+			/* Skip words ending before the target */
+			uint32_t const *const w = begin + m_summary.skip_bits(
+				begin,
+				static_cast<uint64_t>(begin - s18_seq.begin()),
+				static_cast<uint64_t>(end - begin),
+				target_accum,
+				accum,
+				one_cnt
+			);
+			if (w == end) return 0;
+			return word_access(*w, target_accum - accum);
+		}
+
+		/* Bit `rest` positions after the last 1 bit before w, which lies within w */
+		static uint64_t word_access(uint32_t const w, uint64_t const rest)
+		{
+			decoder::descriptor const &d = decoder::describe(w);
+			uint64_t const lead = d.leading + (w & d.run_mask);
+			if (rest <= lead) return 1;
+
+			uint64_t reached = 0;
+			decoder::first_reaching(w, rest - lead, reached);
+			return reached == rest - lead;
+		}
+
+		/* 1 bits of w before the bit `rest` positions after the last 1 bit before it */
+		static uint64_t word_rank(uint32_t const w, uint64_t const rest)
+		{
+			decoder::descriptor const &d = decoder::describe(w);
+			uint64_t const lead = d.leading + (w & d.run_mask);
+			if (rest <= lead) return rest - 1;
+
+			uint64_t reached = 0;
+			return lead + decoder::first_reaching(w, rest - lead, reached) - 1;
+		}
 
-				if (accum + 1 + leading_1s >= target_accum + 1)
-					return one_cnt + target_accum - accum - 1;
+		/* Bits of w up to its `counter`-th 1 bit, counter being at most its 1 bits */
+		static uint64_t word_select(uint32_t const w, uint64_t const counter)
+		{
+			decoder::descriptor const &d = decoder::describe(w);
+			uint64_t const lead = d.leading + (w & d.run_mask);
+			if (counter <= lead) return counter;
+			return lead + decoder::chunk_sum(w, counter - lead);
+		}
 
-				accum += leading_1s;
-				one_cnt += leading_1s;
+		/*
+		 * A word within a block and the totals from the block samples up
+		 * to it, kept across a run of queries so that each one resumes
+		 * the scan of the last when it lands in the same block further on.
+		 * The samples around the block are kept too, so a query that
+		 * stays in it reads none of them, and so is the chunk of the word
+		 * the last query ended at, so the next one starts looking there.
+		 */
+		struct finger
+		{
+			uint64_t blk;          // Block, -1 before the first query
+			uint64_t word;         // Index of the word in s18_seq
+			uint64_t accum;        // Last 1 bit before the word, from bits_before - 1
+			uint64_t ones;         // 1 bits before the word, from ones_before
+			uint64_t bits_before;  // idx_bits[blk]
+			uint64_t ones_before;  // idx_ones[blk]
+			uint64_t bits_after;   // idx_bits[blk + 1], -1 for the last block
+			uint64_t ones_after;   // idx_ones[blk + 1], -1 for the last block
+			uint64_t chunk;        // Chunks of the word up to the last query, 0 for none
+			uint64_t chunk_lo;     // Sum of the chunks before it
+			uint64_t chunk_hi;     // Sum of the chunks up to it
+		};
+
+		static finger no_finger(void)
+		{
+			return {uint64_t(-1), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+		}
 
-				for (uint64_t i = 0; i < len; i++, one_cnt++) {
-					uint64_t wi = w.access_fast(i, _case);
-					if (wi == 0) break; /* Word was not full */
+		/* Point f at the first word of block blk */
+		void enter(finger &f, uint64_t const blk) const
+		{
+			bool const last = blk + 1 >= idx_bits.size();
+			f = {
+				blk,
+				std::min<uint64_t>(blk * b_s, s18_seq_size),
+				uint64_t(-1),
+				0,
+				idx_bits[blk],
+				idx_ones[blk],
+				last ? uint64_t(-1) : idx_bits[blk + 1],
+				last ? uint64_t(-1) : idx_ones[blk + 1],
+				0,
+				0,
+				0
+			};
+		}
 
-					accum += wi;
-					if (accum >= target_accum) return one_cnt;
+		/* Move f to the first word of key's block whose last 1 bit is at or after key */
+		uint64_t seek_bits(finger &f, uint64_t const key) const
+		{
+			bool const here = f.blk != uint64_t(-1)
+				and f.bits_before <= key
+				and key < f.bits_after
+				and key - f.bits_before >= f.accum + 1;
+			if (not here) {
+				uint64_t blk = f.blk;
+				if (blk == uint64_t(-1) or key < f.bits_before) {
+					blk = block_by_bits(key);
+				} else {
+					/* Blocks close ahead are walked, far ones looked up */
+					for (uint64_t i = 0; i < NEAR_BLOCKS and blk + 1 < idx_bits.size() and idx_bits[blk + 1] <= key; i++)
+						blk++;
+					if (blk + 1 < idx_bits.size() and idx_bits[blk + 1] <= key)
+						blk = block_by_bits(key);
 				}
+				enter(f, blk);
 			}
 
-			return one_cnt;
+			uint64_t const end = std::min<uint64_t>(f.blk * b_s + b_s, s18_seq_size);
+			uint64_t const target = key - f.bits_before;
+			if (f.word < end and f.accum + m_summary.span(f.word, s18_seq[f.word]) >= target)
+				return target - f.accum;  /* Still within the word */
+			uint64_t const skipped = m_summary.skip_bits(s18_seq.begin() + f.word, f.word, end - f.word, target, f.accum, f.ones);
+			if (skipped) {
+				f.word += skipped;
+				f.chunk = 0;
+			}
+			return f.word == end ? 0 : target - f.accum;
 		}
-	public:
-		rank_support(void)=delete;
-		rank_support(vector<b_s, vector_type> &cv)
-			: bv(cv)
-		{}
-		uint64_t operator()(uint64_t const key) const
+
+		/* Move f to the word of the block holding the `key`-th 1 bit that holds it */
+		uint64_t seek_ones(finger &f, uint64_t const key) const
 		{
-			return q ? rank1(key) : rank0(key);
+			bool const here = f.blk != uint64_t(-1)
+				and f.ones_before < key
+				and key <= f.ones_after
+				and key - f.ones_before >= f.ones;
+			if (not here) {
+				uint64_t blk = f.blk;
+				if (blk == uint64_t(-1) or key <= f.ones_before) {
+					blk = block_by_ones(key);
+				} else {
+					/* Blocks close ahead are walked, far ones looked up */
+					for (uint64_t i = 0; i < NEAR_BLOCKS and blk + 1 < idx_ones.size() and idx_ones[blk + 1] < key; i++)
+						blk++;
+					if (blk + 1 < idx_ones.size() and idx_ones[blk + 1] < key)
+						blk = block_by_ones(key);
+				}
+				enter(f, blk);
+			}
+
+			uint64_t const end = std::min<uint64_t>(f.blk * b_s + b_s, s18_seq_size);
+			uint64_t counter = key - f.ones_before - f.ones;
+			uint64_t accum = f.accum + 1;
+			uint64_t const skipped = m_summary.skip_ones(s18_seq.begin() + f.word, f.word, end - f.word, counter, accum);
+			if (skipped) {
+				f.word += skipped;
+				f.chunk = 0;
+			}
+			f.accum = accum - 1;
+			f.ones = key - f.ones_before - counter;
+			return counter;
 		}
-};
 
-template<uint8_t q, uint16_t b_s, class vector_type>
-class select_support
-{
-	static_assert(q < 2, "select_support: bit pattern must be `0` or `1`");
-	private:
-		vector<b_s, vector_type> const &bv;
+		/* Chunks of w whose sum reaches x, trying the chunk f ended at and the next one first */
+		static uint64_t reach(finger &f, uint32_t const w, uint64_t const x)
+		{
+			if (f.chunk and f.chunk_lo < x and x <= f.chunk_hi)
+				return f.chunk;
+			if (f.chunk and f.chunk_hi < x) {
+				uint64_t const next = decoder::chunk_sum(w, f.chunk + 1);
+				if (x <= next) {
+					f.chunk++;
+					f.chunk_lo = f.chunk_hi;
+					f.chunk_hi = next;
+					return f.chunk;
+				}
+			}
 
-		typedef typename vector_type::iterator       iterator_type;
-		typedef typename vector_type::const_iterator const_iterator_type;
+			f.chunk = decoder::first_reaching(w, x, f.chunk_hi);
+			f.chunk_lo = decoder::chunk_sum(w, f.chunk - 1);
+			return f.chunk;
+		}
 
-	private:
-		uint64_t select0(uint64_t const key) const
+		/* Queries through a finger, answered like their supports */
+		uint64_t finger_rank(finger &f, uint64_t const key) const
 		{
-			return key;
+			uint64_t const rest = seek_bits(f, key);
+			uint64_t const ones = f.ones_before + f.ones;
+			if (rest == 0) return ones;
+
+			uint32_t const w = s18_seq[f.word];
+			decoder::descriptor const &d = decoder::describe(w);
+			uint64_t const lead = d.leading + (w & d.run_mask);
+			if (rest <= lead) return ones + rest - 1;
+			return ones + lead + reach(f, w, rest - lead) - 1;
 		}
 
-		uint64_t select1(uint64_t const key) const
+		uint64_t finger_access(finger &f, uint64_t const key) const
 		{
-			uint64_t pos = bv.l2_ones[key / bv.l2_ones_div] - 1;
-			return bv.idx_bits[pos] + partial_sum(
-				bv.s18_seq.begin() + pos * b_s,
-				bv.s18_seq.end(),
-				key - bv.idx_ones[pos]
-			);
+			uint64_t const rest = seek_bits(f, key);
+			if (rest == 0) return 0;
+
+			uint32_t const w = s18_seq[f.word];
+			decoder::descriptor const &d = decoder::describe(w);
+			uint64_t const lead = d.leading + (w & d.run_mask);
+			if (rest <= lead) return 1;
+			reach(f, w, rest - lead);
+			return f.chunk_hi == rest - lead;
 		}
 
-		uint64_t partial_sum(int_vector<32>::const_iterator const begin, int_vector<32>::const_iterator const end, uint64_t counter) const
+		uint64_t finger_successor(finger &f, uint64_t const key) const
 		{
-			int_vector<32>::const_iterator gaps = begin;
-			uint64_t accum = 0;
+			if (key >= m_size) return m_size;
+
+			uint64_t const rest = seek_bits(f, key);
+			if (rest == 0) return m_size;
 
-			for (; std::distance(gaps, end) > 0 and counter; gaps++) {
-				word w(*gaps);
-				auto const [_case, leading_1s, len] = w.metadata();
+			uint32_t const w = s18_seq[f.word];
+			decoder::descriptor const &d = decoder::describe(w);
+			uint64_t const lead = d.leading + (w & d.run_mask);
+			if (rest <= lead) return key;
+			reach(f, w, rest - lead);
+			return f.bits_before + f.accum + lead + f.chunk_hi;
+		}
+
+		uint64_t finger_select(finger &f, uint64_t const key) const
+		{
+			uint64_t const counter = seek_ones(f, key);
+			uint64_t const pos = f.bits_before + f.accum + 1;
+			return counter ? pos + word_select(s18_seq[f.word], counter) : pos;
+		}
+
+		/*
+		 * Answer n queries as out[i] = answer(f, keys[i]) with a single
+		 * finger, in increasing key order so it only moves forward.
+		 * Unsorted keys are answered through a sorted copy of (key, index)
+		 * pairs.
+		 */
+		template<class function>
+		static void batch(uint64_t const *keys, uint64_t const n, uint64_t *out, function &&answer)
+		{
+			finger f = no_finger();
+			if (std::is_sorted(keys, keys + n)) {
+				for (uint64_t i = 0; i < n; i++)
+					out[i] = answer(f, keys[i]);
+				return;
+			}
+
+			std::vector<std::pair<uint64_t, uint64_t>> order(n);
+			for (uint64_t i = 0; i < n; i++)
+				order[i] = std::make_pair(keys[i], i);
+			std::sort(order.begin(), order.end());
+			for (std::pair<uint64_t, uint64_t> const &q : order)
+				out[q.second] = answer(f, q.first);
+		}
+
+		/* Fetch the cache line holding v[i] ahead of its use */
+		template<class t_vector>
+		static void prefetch(t_vector const &v, uint64_t const i)
+		{
+			__builtin_prefetch(reinterpret_cast<char const *>(v.data()) + ((i * v.width()) >> 3));
+		}
 
-				accum += std::min(counter, leading_1s);
-				counter -= std::min(counter, leading_1s);
+		static void prefetch(counters const &v, uint64_t const i)
+		{
+			__builtin_prefetch(v.line(i));
+		}
 
-				for (uint64_t i = 0; i < len and counter; i++, counter--) {
-					uint64_t wi = w.access_fast(i, _case);
-					if (wi == 0) break; /* Word was not full */
-					accum += wi;
+		/*
+		 * Answer n queries as out[i] = answer(blk, keys[i]), blk being the
+		 * block found by bits (or by ones when `by_ones`), with G queries
+		 * in flight. A query reads the l2 sample, the block samples and
+		 * the block words, each depending on the last; a prefetch is
+		 * issued before every step and the next query in flight takes
+		 * over while it lands.
+		 */
+		template<uint64_t G, bool by_ones, class function>
+		void interleave(uint64_t const *keys, uint64_t const n, uint64_t *out, function &&answer) const
+		{
+			static_assert(G > 0, "vector::interleave: at least one query must be in flight");
+
+			samples_type const &l2 = by_ones ? l2_ones : l2_bits;
+			samples_type const &idx = by_ones ? idx_ones : idx_bits;
+			samples_type const &other = by_ones ? idx_bits : idx_ones;
+			uint64_t const div = by_ones ? l2_ones_div : l2_bits_div;
+
+			struct probe
+			{
+				uint64_t i;      // Query, n when the slot is idle
+				uint64_t blk;
+				uint8_t  stage;  // Next step to take
+			} slots[G];
+
+			uint64_t next = 0;
+			uint64_t live = 0;
+			for (probe &q : slots) {
+				q = {n, 0, 0};
+				if (next < n) {
+					q.i = next++;
+					prefetch(l2, l2_index(l2, keys[q.i], div));
+					live++;
 				}
 			}
 
-#if DEBUG
-			if (counter)
-				throw std::runtime_error("select_support_s17::partial_sum: vector consumed before target counter");
-#endif
-			return accum;
+			while (live) {
+				for (probe &q : slots) {
+					if (q.i == n) continue;
+					uint64_t const key = keys[q.i];
+
+					switch (q.stage) {
+						case 0: /* l2 sample has landed */
+							q.blk = l2[l2_index(l2, key, div)] - 1;
+							prefetch(idx, q.blk + 1);
+							q.stage = 1;
+							break;
+						case 1: /* Block samples have landed */
+							while (q.blk + 1 < idx.size() and (by_ones ? idx[q.blk + 1] < key : idx[q.blk + 1] <= key))
+								q.blk++;
+							prefetch(other, q.blk);
+							for (uint64_t w = 0; w < b_s and w < PREFETCH_WORDS; w += 16)
+								prefetch(s18_seq, q.blk * b_s + w);
+							q.stage = 2;
+							break;
+						default: /* Block words have landed */
+							out[q.i] = answer(q.blk, key);
+							q = {n, 0, 0};
+							if (next < n) {
+								q.i = next++;
+								prefetch(l2, l2_index(l2, keys[q.i], div));
+							} else {
+								live--;
+							}
+							break;
+					}
+				}
+			}
 		}
-	public:
-		select_support(void)=delete;
-		select_support(vector<b_s, vector_type> &cv)
-			: bv(cv)
-		{}
-		uint64_t operator()(uint64_t const key) const
+
+		/*
+		 * Encode bv one 1 bit at a time, so no positions or gaps are kept
+		 * around besides the word being filled
+		 */
+		static vector encode(bit_vector const &bv, packing const p = packing::greedy)
 		{
-			return q ? select1(key) : select0(key);
+			builder<b_s, vector_type, summary_type> b(bv.size(), p);
+			for_each_one(bv, 0, bv.size(), [&b](uint64_t const i) { b.push_back(i); });
+			return b.build();
 		}
-};
+
+		/*
+		 * Call f(i) for every 1 bit i of bv[lo, hi), lo being a multiple of
+		 * 64. Walks bv a 64 bit word at a time: runs of empty words are
+		 * skipped four at a time, full words emit 64 positions straight
+		 * away and any other word is consumed with ctz.
+		 */
+		template<class function>
+		static void for_each_one(bit_vector const &bv, uint64_t const lo, uint64_t const hi, function &&f)
+		{
+			uint64_t const *const data = bv.data();
+			for (uint64_t i = lo; i < hi; i += 64) {
+				while (i + 256 <= hi and (data[i / 64] | data[i / 64 + 1] | data[i / 64 + 2] | data[i / 64 + 3]) == 0)
+					i += 256;
+				if (i >= hi)
+					break;
+
+				uint64_t bits = data[i / 64];
+				if (hi - i < 64)
+					bits &= (uint64_t(1) << (hi - i)) - 1;
+
+				if (bits == ~uint64_t(0)) {
+					for (uint64_t j = i; j < i + 64; j++) f(j);
+					continue;
+				}
+				for (; bits; bits &= bits - 1)
+					f(i + static_cast<uint64_t>(__builtin_ctzll(bits)));
+			}
+		}
+
+		/* First 1 bit after bit i, there must be one */
+		static uint64_t next_one(bit_vector const &bv, uint64_t const i)
+		{
+			uint64_t const *const data = bv.data();
+			uint64_t pos = (i + 1) / 64;
+			uint64_t bits = data[pos] & (~uint64_t(0) << ((i + 1) % 64));
+			while (not bits)
+				bits = data[++pos];
+			return pos * 64 + static_cast<uint64_t>(__builtin_ctzll(bits));
+		}
+
+		/* Words packed from the 1 bits of bv[lo, hi) that follow the first one */
+		struct segment
+		{
+			uint64_t              lo;
+			uint64_t              hi;
+			uint64_t              first;  // First 1 bit, hi if there is none
+			uint64_t              last;   // Last 1 bit
+			uint64_t              ones;
+			bool                  valid;  // Every gap fits in a word
+			std::vector<uint32_t> words;
+		};
+
+		static void pack_segment(bit_vector const &bv, segment &s)
+		{
+			word w = word();
+			bool pending = false;
+			for_each_one(bv, s.lo, s.hi, [&](uint64_t const i) {
+				s.ones++;
+				if (s.first == s.hi) {
+					s.first = s.last = i;
+					return;
+				}
+
+				uint64_t const gap = i - s.last;
+				s.last = i;
+				if (gap > MASK_BODY4)
+					s.valid = false;
+				if (not s.valid)
+					return;
+				if (not w.add_if_enough_space(static_cast<uint32_t>(gap))) {
+					s.words.push_back(w.pack());
+					w = word();
+					w.add_if_enough_space(static_cast<uint32_t>(gap));
+				}
+				pending = true;
+			});
+			if (pending and s.valid) s.words.push_back(w.pack());
+		}
+
+		/* Feed the gaps encoded in w back into an empty word */
+		static void reopen(uint32_t const w, word &into)
+		{
+			decoder::descriptor const &d = decoder::describe(w);
+			uint64_t const lead = d.leading + (w & d.run_mask);
+			uint64_t const chunks = decoder::ones(w) - lead;
+
+			for (uint64_t i = 0; i < lead; i++)
+				into.add_if_enough_space(1);
+			for (uint64_t k = 1, before = 0; k <= chunks; k++) {
+				uint64_t const sum = decoder::chunk_sum(w, k);
+				into.add_if_enough_space(static_cast<uint32_t>(sum - before));
+				before = sum;
+			}
+		}
+
+		/*
+		 * Parallel encoding. Segments are packed on their own, then
+		 * stitched in order: the last word so far is reopened and the next
+		 * segment is packed again from its first gap until a word closes
+		 * where one of its own words starts. From there on greedy packing
+		 * gives the same words, so they are copied. The result is the
+		 * serial encoding, word for word.
+		 */
+		static vector encode(bit_vector const &bv, uint64_t const threads)
+		{
+			uint64_t const step = std::max<uint64_t>((bv.size() / threads + 63) / 64 * 64, 64);
+			std::vector<segment> segments;
+			for (uint64_t lo = 0; lo < bv.size(); lo += step) {
+				uint64_t const hi = std::min(lo + step, bv.size());
+				segments.push_back(segment{lo, hi, hi, hi, 0, true, {}});
+			}
+
+			std::vector<std::thread> workers;
+			for (segment &s : segments)
+				workers.emplace_back(pack_segment, std::cref(bv), std::ref(s));
+			for (std::thread &t : workers)
+				t.join();
+
+			int_vector<32> seq(64, 0);
+			uint64_t seq_size = 0;
+			auto const put = [&seq, &seq_size](uint32_t const w) {
+				if (seq_size == seq.size())
+					seq.resize(2 * seq.size());
+				seq[seq_size++] = w;
+			};
+			/* Add gap to w, true if w had to be closed */
+			auto const feed = [&put](word &w, uint64_t const gap) {
+				if (w.add_if_enough_space(static_cast<uint32_t>(gap)))
+					return false;
+				put(w.pack());
+				w = word();
+				w.add_if_enough_space(static_cast<uint32_t>(gap));
+				return true;
+			};
+
+			uint64_t ones = 0;
+			uint64_t last = -1;
+			for (segment const &s : segments) {
+				if (not s.valid or (s.first != s.hi and s.first - last > MASK_BODY4))
+					throw std::invalid_argument("vector::vector: gaps must be between 1 and 2^28 - 1");
+				if (s.first == s.hi)
+					continue;
+
+				word cur = word();
+				if (seq_size)
+					reopen(seq[--seq_size], cur);
+				feed(cur, s.first - last);
+
+				/* Gap k + 1 of the segment starts word j when `start` equals k */
+				uint64_t j = 0;
+				uint64_t start = 0;
+				bool synced = false;
+				for (uint64_t i = s.first, k = 0; not synced and i != s.last; k++) {
+					uint64_t const prev = i;
+					i = next_one(bv, i);
+					if (feed(cur, i - prev)) {
+						while (j < s.words.size() and start < k)
+							start += decoder::ones(s.words[j++]);
+						synced = j < s.words.size() and start == k;
+					}
+				}
+
+				if (synced)
+					for (; j < s.words.size(); j++) put(s.words[j]);
+				else
+					put(cur.pack());
+				ones += s.ones;
+				last = s.last;
+			}
+
+			/* Block samples, as taken by the builder */
+			int_vector<> bits(seq_size / b_s + 2, 0);
+			int_vector<> ones_before(seq_size / b_s + 2, 0);
+			uint64_t size_idx = 1;
+			for (uint64_t i = 0, b = 0, o = 0; i < seq_size; i++) {
+				b += decoder::span(seq[i]);
+				o += decoder::ones(seq[i]);
+				if ((i + 1) % b_s == 0 or i + 1 == seq_size) {
+					bits[size_idx] = b;
+					ones_before[size_idx] = o;
+					size_idx++;
+				}
+			}
+			bits.resize(size_idx);
+			ones_before.resize(size_idx);
+
+			return vector(bv.size(), ones, std::move(seq), seq_size, std::move(bits), std::move(ones_before));
+		}
+};
+
+
+/*
+ * S18 builder
+ *
+ * Encodes a bit vector from the positions of its 1 bits, given in
+ * increasing order, without materializing the uncompressed vector.
+ *
+ * With packing::optimal gaps are buffered in windows of WINDOW gaps and
+ * split into the fewest words that hold them. Words are still built by
+ * word, so they use the same 17 cases and decode as usual.
+ */
+template<uint16_t b_s, class vector_type, class summary_type>
+class builder
+{
+	static_assert(not storage<vector_type>::mapped, "builder: a mapped_vector views a file, build a vector and serialize() it");
+
+	private:
+		uint64_t       m_size;          // Length of the bit vector, 0 to end at the last 1
+		uint64_t       m_ones;          // 1 bits pushed so far
+		uint64_t       m_bits;          // Last position pushed plus 1
+		word           current;         // Word being filled
+		uint64_t       current_ones;
+		uint64_t       current_bits;
+		uint64_t       packed_ones;     // 1 bits in packed words
+		uint64_t       packed_bits;     // Bits spanned by packed words
+		uint64_t       s18_seq_size;
+		int_vector<32> s18_seq;
+		uint64_t       size_idx;
+		int_vector<>   idx_bits;
+		int_vector<>   idx_ones;
+
+		/* Optimal packing */
+		static uint64_t constexpr WINDOW = 4096;
+		static uint64_t constexpr MARGIN = 128;   // Gaps left for the next window
+		static uint64_t constexpr RUN_KEPT = 56;  // 1s opening a window it decides on
+		packing               m_packing;
+		uint64_t              window_run;  // 1s opening the window, not in `window`
+		std::vector<uint32_t> window;      // Gaps after them, the first one is not 1
+		std::vector<uint32_t> gaps;        // Scratch space for partition()
+		std::vector<uint32_t> ones_from;   // Length of the run of 1s at each gap
+		std::vector<uint32_t> reach;       // Most gaps a word starting at each gap holds
+		std::vector<uint64_t> starts;      // First gap of each chosen word
+
+	public:
+		builder(uint64_t const size = 0, packing const p = packing::greedy)
+			: m_size(size)
+			, m_ones(0)
+			, m_bits(0)
+			, current()
+			, current_ones(0)
+			, current_bits(0)
+			, packed_ones(0)
+			, packed_bits(0)
+			, s18_seq_size(0)
+			, s18_seq(64, 0)
+			, size_idx(1)
+			, idx_bits(4, 0)
+			, idx_ones(4, 0)
+			, m_packing(p)
+			, window_run(0)
+			, window()
+			, gaps()
+			, ones_from()
+			, reach()
+			, starts()
+		{} /* end builder::builder */
+
+		/* Set bit `pos`, which must be greater than every bit set so far */
+		void push_back(uint64_t const pos)
+		{
+			if (pos < m_bits)
+				throw std::invalid_argument("builder::push_back: positions must be strictly increasing");
+			push_gap(pos + 1 - m_bits);
+		}
+
+		/* Set the bit `gap` positions after the last one set (or after -1) */
+		void push_gap(uint64_t const gap)
+		{
+			if (gap == 0 or gap > MASK_BODY4)
+				throw std::invalid_argument("builder::push_gap: gaps must be between 1 and 2^28 - 1");
+
+			m_ones++;
+			m_bits += gap;
+
+			if (m_packing == packing::optimal) {
+				if (window.empty() and gap == 1) {
+					/* Keep some 1s around for a word with leading 1s */
+					if (++window_run == MASK_BODY5 + RUN_KEPT) {
+						put_run(MASK_BODY5);
+						window_run -= MASK_BODY5;
+					}
+					return;
+				}
+				window.push_back(static_cast<uint32_t>(gap));
+				if (window.size() >= WINDOW)
+					partition(false);
+				return;
+			}
+
+			add(static_cast<uint32_t>(gap));
+		}
+
+		/* Set every position in [first, last) */
+		template<class iterator>
+		void append(iterator first, iterator const last)
+		{
+			for (; first != last; ++first)
+				push_back(static_cast<uint64_t>(*first));
+		}
+
+		uint64_t ones(void) const
+		{
+			return m_ones;
+		}
+
+		/* Encode pending positions into a vector, leaving the builder empty */
+		vector<b_s, vector_type, summary_type> build(void)
+		{
+			if (m_size and m_size < m_bits)
+				throw std::invalid_argument("builder::build: a position lies past the size of the vector");
+
+			if (m_packing == packing::optimal)
+				partition(true);
+			if (current_ones)
+				pack();
+			if (s18_seq_size % b_s)
+				sample();
+
+			idx_bits.resize(size_idx);
+			idx_ones.resize(size_idx);
+
+			vector<b_s, vector_type, summary_type> v(
+				m_size ? m_size : m_bits,
+				m_ones,
+				std::move(s18_seq),
+				s18_seq_size,
+				std::move(idx_bits),
+				std::move(idx_ones)
+			);
+
+			*this = builder(m_size, m_packing);
+			return v;
+		}
+
+	private:
+		void add(uint32_t const gap)
+		{
+			if (not current.add_if_enough_space(gap)) {
+				pack();
+				current.add_if_enough_space(gap);
+			}
+			current_ones++;
+			current_bits += gap;
+		}
+
+		/* Word with a run of n 1s */
+		void put_run(uint64_t const n)
+		{
+			for (uint64_t i = 0; i < n; i++)
+				add(1);
+			pack();
+		}
+
+		/*
+		 * Split the window into the fewest words. reach[i] is the most gaps
+		 * a word starting at gap i can hold, so this is a jump game: each
+		 * round extends the farthest gap coverable with one more word, and
+		 * the start giving it is kept as the next word. Unless `all` is
+		 * set, words starting in the last MARGIN gaps stay in the window
+		 * to be decided along with later gaps.
+		 */
+		void partition(bool const all)
+		{
+			/* Nothing but 1s, only left at the end */
+			for (uint64_t n; window.empty() and window_run; window_run -= n) {
+				n = std::min<uint64_t>(window_run, MASK_BODY5);
+				put_run(n);
+			}
+
+			/*
+			 * A word holds at most 41 1s of a run before other gaps, so the
+			 * first word out of RUN_KEPT 1s is a run and the rest of a longer
+			 * one goes in front of it
+			 */
+			uint64_t const extra = window_run > RUN_KEPT ? window_run - RUN_KEPT : 0;
+			for (uint64_t i = 0; i < extra; i++)
+				add(1);
+			window_run -= extra;
+
+			gaps.assign(window_run, 1);
+			gaps.insert(gaps.end(), window.begin(), window.end());
+			uint64_t const n = gaps.size();
+			if (n == 0) return;
+
+			ones_from.resize(n + 1);
+			ones_from[n] = 0;
+			for (uint64_t i = n; i-- > 0;)
+				ones_from[i] = gaps[i] == 1 ? std::min<uint32_t>(ones_from[i + 1] + 1, MASK_BODY5) : 0;
+
+			reach.resize(n);
+			for (uint64_t i = 0; i < n; i++) {
+				/* Run of 1s, or 28 leading 1s and chunks of 2 bits or more after them */
+				uint64_t best = ones_from[i];
+				if (ones_from[i] >= 28 and i + 28 < n)
+					best = std::max<uint64_t>(best, 28 + chunks_from(i + 28, 2));
+				reach[i] = static_cast<uint32_t>(std::max(best, chunks_from(i, 1)));
+			}
+
+			starts.assign(1, 0);
+			for (uint64_t i = 1, end = reach[0]; end < n;) {
+				uint64_t next = end;
+				uint64_t from = end;
+				for (; i <= end; i++) {
+					if (i + reach[i] > next) {
+						next = i + reach[i];
+						from = i;
+					}
+				}
+				starts.push_back(from);
+				end = next;
+			}
+
+			/* Reaches are cut short near the end, so decide those words later */
+			uint64_t keep = all ? n : starts.back();
+			for (uint64_t k = 0; not all and k < starts.size(); k++) {
+				if (starts[k] + MARGIN >= n) {
+					keep = starts[k];
+					break;
+				}
+			}
+			starts.push_back(n);
+			for (uint64_t k = 0; starts[k] < keep; k++) {
+				uint64_t const first = starts[k];
+				for (uint64_t i = first; i < starts[k + 1]; i++) {
+					add(gaps[i]);
+					/* A run going on past the 28 leading 1s of a word is cut there */
+					if (i == first + 27 and ones_from[first] > 28 and starts[k + 1] - first > ones_from[first])
+						current.close_leading_1s();
+				}
+				pack();
+			}
+
+			/* Carry the last word over to the next window */
+			window_run = 0;
+			window.clear();
+			for (uint64_t i = keep; i < n; i++) {
+				if (window.empty() and gaps[i] == 1) window_run++;
+				else window.push_back(gaps[i]);
+			}
+		}
+
+		/* Most gaps from gaps[i] on that fit in the chunks of one word */
+		uint64_t chunks_from(uint64_t const i, uint64_t const min_bits) const
+		{
+			uint64_t width = min_bits;
+			uint64_t k = 0;
+			while (i + k < gaps.size()) {
+				width = std::max(width, word::chunk_bits(gaps[i + k]));
+				if ((k + 1) * width > 28) break;
+				k++;
+			}
+			return k;
+		}
+
+		void pack(void)
+		{
+			if (s18_seq_size == s18_seq.size())
+				s18_seq.resize(2 * s18_seq.size());
+			s18_seq[s18_seq_size++] = current.pack();
+
+			packed_ones += current_ones;
+			packed_bits += current_bits;
+			current = word();
+			current_ones = 0;
+			current_bits = 0;
+
+			if (s18_seq_size % b_s == 0)
+				sample();
+		}
+
+		/* Totals before the next block */
+		void sample(void)
+		{
+			if (size_idx == idx_bits.size()) {
+				idx_bits.resize(2 * idx_bits.size());
+				idx_ones.resize(2 * idx_ones.size());
+			}
+			idx_bits[size_idx] = packed_bits;
+			idx_ones[size_idx] = packed_ones;
+			size_idx++;
+		}
+};
+
+
+template<uint16_t b_s, class vector_type, class summary_type>
+class access_support
+{
+	private:
+		vector<b_s, vector_type, summary_type> const &bv;
+	public:
+		access_support(void)=delete;
+		access_support(vector<b_s, vector_type, summary_type> &cv)
+			: bv(cv)
+		{}
+		uint64_t operator()(uint64_t const key) const { return bv[key]; }
+
+};
+
+template<uint8_t q, uint16_t b_s, class vector_type, class summary_type>
+class rank_support
+{
+	static_assert(q < 2, "rank_support: bit pattern must be `0` or `1`");
+	private:
+		vector<b_s, vector_type, summary_type> const &bv;
+
+		typedef typename vector_type::iterator       iterator_type;
+		typedef typename vector_type::const_iterator const_iterator_type;
+
+	private:
+		uint64_t rank0(uint64_t const key) const
+		{
+			return key - rank1(key);
+		}
+
+		uint64_t rank1(uint64_t const key) const
+		{
+			return block_rank1(bv.block_by_bits(key), key);
+		}
+
+		uint64_t block_rank1(uint64_t const pos, uint64_t const key) const
+		{
+			return bv.idx_ones[pos] + find_block_nth(
+				bv.block_begin(pos),
+				bv.block_end(pos),
+				key - bv.idx_bits[pos]
+			);
+		}
+
+		uint64_t find_block_nth(uint32_t const *const begin, uint32_t const *const end, uint64_t target_accum) const
+		{
+			uint64_t accum = -1;
+			uint64_t one_cnt = 0;
+
+			/* Skip words ending before the target */
+			uint32_t const *const w = begin + bv.m_summary.skip_bits(
+				begin,
+				static_cast<uint64_t>(begin - bv.s18_seq.begin()),
+				static_cast<uint64_t>(end - begin),
+				target_accum,
+				accum,
+				one_cnt
+			);
+			if (w == end) return one_cnt;
+			return one_cnt + bv.word_rank(*w, target_accum - accum);
+		}
+	public:
+		rank_support(void)=delete;
+		rank_support(vector<b_s, vector_type, summary_type> &cv)
+			: bv(cv)
+		{}
+		uint64_t operator()(uint64_t const key) const
+		{
+			return q ? rank1(key) : rank0(key);
+		}
+
+		/*
+		 * out[i] = (*this)(keys[i]) for n keys. Keys falling in the same
+		 * block are answered by resuming the scan of the previous one.
+		 */
+		void rank_batch(uint64_t const *keys, uint64_t const n, uint64_t *out) const
+		{
+			bv.batch(keys, n, out, [this](typename vector<b_s, vector_type, summary_type>::finger &f, uint64_t const key) {
+				uint64_t const ones = bv.finger_rank(f, key);
+				return q ? ones : key - ones;
+			});
+		}
+
+		/*
+		 * out[i] = (*this)(keys[i]) for n keys in any order, G of them in
+		 * flight at once to overlap their cache misses
+		 */
+		template<uint64_t G = 16>
+		void rank_interleaved(uint64_t const *keys, uint64_t const n, uint64_t *out) const
+		{
+			bv.template interleave<G, false>(keys, n, out, [this](uint64_t const pos, uint64_t const key) {
+				uint64_t const ones = block_rank1(pos, key);
+				return q ? ones : key - ones;
+			});
+		}
+};
+
+template<uint8_t q, uint16_t b_s, class vector_type, class summary_type>
+class select_support
+{
+	static_assert(q < 2, "select_support: bit pattern must be `0` or `1`");
+	private:
+		vector<b_s, vector_type, summary_type> const &bv;
+
+		typedef typename vector_type::iterator       iterator_type;
+		typedef typename vector_type::const_iterator const_iterator_type;
+
+	private:
+		/*
+		 * Like select1, the position after the `key`-th 0 bit. Leading 1s
+		 * and runs hold no 0 bits and a gap g holds g - 1 of them, so the
+		 * block is found by its 0 bits before it (bits minus ones), words
+		 * are skipped by span minus ones, and the gap holding the target
+		 * is found by binary search over chunk sums minus chunk counts.
+		 */
+		uint64_t select0(uint64_t const key) const
+		{
+			uint64_t const pos = bv.block_by_zeros(key);
+			uint32_t const *const begin = bv.block_begin(pos);
+			uint32_t const *const end = bv.block_end(pos);
+			uint64_t counter = key - (bv.idx_bits[pos] - bv.idx_ones[pos]);
+			uint64_t accum = 0;
+
+			/* Skip words holding fewer 0 bits than the ones left */
+			uint32_t const *w = begin;
+			for (; w != end; w++) {
+				uint64_t const i = static_cast<uint64_t>(w - bv.s18_seq.begin());
+				uint64_t const span = bv.m_summary.span(i, *w);
+				uint64_t const zeros = span - bv.m_summary.ones(i, *w);
+				if (zeros >= counter) break;
+				accum += span;
+				counter -= zeros;
+			}
+
+			/* Past the last 1 bit, 0 bits run to the end */
+			if (w == end) return bv.idx_bits[pos] + accum + counter;
+
+			/* Target lies within the chunks of this word */
+			decoder::descriptor const &d = decoder::describe(*w);
+			uint64_t const lead = d.leading + (*w & d.run_mask);
+			uint64_t lo = 1;
+			uint64_t hi = decoder::ones(*w) - lead;
+			while (lo < hi) {
+				uint64_t const mid = (lo + hi) / 2;
+				if (decoder::chunk_sum(*w, mid) - mid >= counter) hi = mid;
+				else lo = mid + 1;
+			}
+			uint64_t const before = decoder::chunk_sum(*w, lo - 1);
+			return bv.idx_bits[pos] + accum + lead + before + counter - (before - (lo - 1));
+		}
+
+		uint64_t select1(uint64_t const key) const
+		{
+			return block_select1(bv.block_by_ones(key), key);
+		}
+
+		uint64_t block_select1(uint64_t const pos, uint64_t const key) const
+		{
+			return bv.idx_bits[pos] + partial_sum(
+				bv.block_begin(pos),
+				bv.block_end(pos),
+				key - bv.idx_ones[pos]
+			);
+		}
+
+		uint64_t partial_sum(uint32_t const *const begin, uint32_t const *const end, uint64_t counter) const
+		{
+			uint64_t accum = 0;
+
+			/* Skip words holding no more than the ones left */
+			uint32_t const *const w = begin + bv.m_summary.skip_ones(
+				begin,
+				static_cast<uint64_t>(begin - bv.s18_seq.begin()),
+				static_cast<uint64_t>(end - begin),
+				counter,
+				accum
+			);
+
+			if (w != end and counter)
+				return accum + bv.word_select(*w, counter);
+
+#if DEBUG
+			if (counter)
+				throw std::runtime_error("select_support_s17::partial_sum: vector consumed before target counter");
+#endif
+			return accum;
+		}
+	public:
+		select_support(void)=delete;
+		select_support(vector<b_s, vector_type, summary_type> &cv)
+			: bv(cv)
+		{}
+		uint64_t operator()(uint64_t const key) const
+		{
+			return q ? select1(key) : select0(key);
+		}
+
+		/*
+		 * out[i] = (*this)(keys[i]) for n keys. Keys falling in the same
+		 * block are answered by resuming the scan of the previous one.
+		 */
+		void select_batch(uint64_t const *keys, uint64_t const n, uint64_t *out) const
+		{
+			if (not q) {
+				for (uint64_t i = 0; i < n; i++)
+					out[i] = select0(keys[i]);
+				return;
+			}
+			bv.batch(keys, n, out, [this](typename vector<b_s, vector_type, summary_type>::finger &f, uint64_t const key) {
+				return bv.finger_select(f, key);
+			});
+		}
+
+		/*
+		 * out[i] = (*this)(keys[i]) for n keys in any order, G of them in
+		 * flight at once to overlap their cache misses
+		 */
+		template<uint64_t G = 16>
+		void select_interleaved(uint64_t const *keys, uint64_t const n, uint64_t *out) const
+		{
+			if (not q) {
+				for (uint64_t i = 0; i < n; i++)
+					out[i] = select0(keys[i]);
+				return;
+			}
+			bv.template interleave<G, true>(keys, n, out, [this](uint64_t const pos, uint64_t const key) {
+				return block_select1(pos, key);
+			});
+		}
+};
+
+/*
+ * Successor and predecessor
+ *
+ * Both take a single block lookup and a single scan: the block starting
+ * at or before `key` ends with its last 1 bit, so the answer is in that
+ * block (or is the last 1 bit before it). Positions are returned as is,
+ * size() meaning there is none.
+ */
+template<uint16_t b_s, class vector_type, class summary_type>
+class successor_support
+{
+	private:
+		vector<b_s, vector_type, summary_type> const &bv;
+	public:
+		successor_support(void)=delete;
+		successor_support(vector<b_s, vector_type, summary_type> &cv)
+			: bv(cv)
+		{}
+
+		/* First 1 bit at or after key */
+		uint64_t operator()(uint64_t const key) const
+		{
+			if (key >= bv.m_size) return bv.m_size;
+
+			uint64_t const pos = bv.block_by_bits(key);
+			uint32_t const *const begin = bv.block_begin(pos);
+			uint32_t const *const end = bv.block_end(pos);
+			uint64_t const target = key - bv.idx_bits[pos];
+			uint64_t accum = -1;
+			uint64_t one_cnt = 0;
+
+			/* Skip words ending before key */
+			uint32_t const *const w = begin + bv.m_summary.skip_bits(
+				begin,
+				static_cast<uint64_t>(begin - bv.s18_seq.begin()),
+				static_cast<uint64_t>(end - begin),
+				target,
+				accum,
+				one_cnt
+			);
+			if (w == end) return bv.m_size;
+
+			/* Successor lies within this word */
+			decoder::descriptor const &d = decoder::describe(*w);
+			uint64_t const lead = d.leading + (*w & d.run_mask);
+			uint64_t const rest = target - accum;
+			if (rest <= lead) return key;
+
+			uint64_t reached = 0;
+			decoder::first_reaching(*w, rest - lead, reached);
+			return bv.idx_bits[pos] + accum + lead + reached;
+		}
+};
+
+template<uint16_t b_s, class vector_type, class summary_type>
+class predecessor_support
+{
+	private:
+		vector<b_s, vector_type, summary_type> const &bv;
+	public:
+		predecessor_support(void)=delete;
+		predecessor_support(vector<b_s, vector_type, summary_type> &cv)
+			: bv(cv)
+		{}
+
+		/* Last 1 bit at or before key */
+		uint64_t operator()(uint64_t key) const
+		{
+			if (bv.m_size == 0) return 0;
+			key = std::min(key, bv.m_size - 1);
+
+			uint64_t const pos = bv.block_by_bits(key);
+			uint32_t const *const begin = bv.block_begin(pos);
+			uint32_t const *const end = bv.block_end(pos);
+			uint64_t const target = key - bv.idx_bits[pos];
+			uint64_t accum = -1;
+			uint64_t one_cnt = 0;
+
+			/* Skip words ending before key */
+			uint32_t const *const w = begin + bv.m_summary.skip_bits(
+				begin,
+				static_cast<uint64_t>(begin - bv.s18_seq.begin()),
+				static_cast<uint64_t>(end - begin),
+				target,
+				accum,
+				one_cnt
+			);
+
+			/* Predecessor is the last 1 bit before w, unless it lies within w */
+			uint64_t last = accum;
+			if (w != end) {
+				decoder::descriptor const &d = decoder::describe(*w);
+				uint64_t const lead = d.leading + (*w & d.run_mask);
+				uint64_t const rest = target - accum;
+				if (rest <= lead) return key;
+
+				uint64_t reached = 0;
+				uint64_t const k = decoder::first_reaching(*w, rest - lead, reached);
+				if (reached == rest - lead) return key;
+				last = accum + lead + decoder::chunk_sum(*w, k - 1);
+			}
+
+			/* There is no 1 bit before the first block */
+			if (bv.idx_bits[pos] + last + 1 == 0) return bv.m_size;
+			return bv.idx_bits[pos] + last;
+		}
+};
+
+
+/*
+ * Cursor
+ *
+ * Answers rank, select, access and successor queries like their supports,
+ * but remembers the block and word where the last one stopped, with the
+ * totals before that word. A query landing further on in the same block
+ * resumes the word scan from there, one a few blocks ahead walks the
+ * block samples, and only one farther away (or behind) goes back through
+ * l2_bits. Scans over increasing keys touch each word about once.
+ */
+template<uint16_t b_s, class vector_type, class summary_type>
+class cursor
+{
+	private:
+		vector<b_s, vector_type, summary_type> const &bv;
+		typename vector<b_s, vector_type, summary_type>::finger f;
+	public:
+		cursor(void)=delete;
+		cursor(vector<b_s, vector_type, summary_type> const &cv)
+			: bv(cv)
+			, f(cv.no_finger())
+		{}
+
+		/* 1 bits before key, like rank_support<1> */
+		uint64_t rank(uint64_t const key)
+		{
+			return bv.finger_rank(f, key);
+		}
+
+		/* Position after the `key`-th 1 bit, like select_support<1> */
+		uint64_t select(uint64_t const key)
+		{
+			return bv.finger_select(f, key);
+		}
+
+		/* Bit at key, like vector::operator[] */
+		uint64_t access(uint64_t const key)
+		{
+			return bv.finger_access(f, key);
+		}
+
+		/* First 1 bit at or after key, like successor_support */
+		uint64_t successor(uint64_t const key)
+		{
+			return bv.finger_successor(f, key);
+		}
+
+		/* Forget the position, as if no query had been made */
+		void reset(void)
+		{
+			f = bv.no_finger();
+		}
+};
+
+
+/*
+ * Blocked vector
+ *
+ * The words of a vector laid out block by block, each block taking whole
+ * cache lines: a 32 byte header with the bits and the 1 bits before it
+ * and before the next block, its b_s words, then padding. Only the l2
+ * samples are kept apart: one points at a block near the key, and the
+ * walk to the right block reads the headers, the last of them on the
+ * lines the query scans anyway. Padding costs up to 60 bytes per block;
+ * b_s = 8 takes exactly one line.
+ */
+template<uint16_t b_s, class summary_type>
+class blocked_vector
+{
+	private:
+		typedef vector<b_s, int_vector<32>, summary_type> words_of;
+
+		static uint64_t constexpr HEADER = 8;                             // Words taken by the header
+		static uint64_t constexpr STRIDE = (HEADER + b_s + 15) / 16 * 16;  // Words from block to block
+
+		uint64_t      m_ones;
+		uint64_t      m_size;
+		uint64_t      s18_seq_size;
+		aligned_words m_blocks;
+		int_vector<>  l2_bits;
+		int_vector<>  l2_ones;
+		uint64_t      l2_bits_div;
+		uint64_t      l2_ones_div;
+		summary_type  m_summary;  // Indexed by the word as numbered in the vector
+
+		/* Lay the words of v out in blocks, behind their headers; the last block has no next one */
+		template<class vector_type>
+		static aligned_words lay_out(vector<b_s, vector_type, summary_type> const &v)
+		{
+			uint64_t const n = v.idx_bits.size();
+			std::vector<uint32_t> blocks(n * STRIDE, 0);
+			for (uint64_t blk = 0; blk < n; blk++) {
+				uint32_t *const b = blocks.data() + blk * STRIDE;
+				uint64_t const header[4] = {
+					v.idx_bits[blk],
+					v.idx_ones[blk],
+					blk + 1 < n ? v.idx_bits[blk + 1] : UINT64_MAX,
+					blk + 1 < n ? v.idx_ones[blk + 1] : UINT64_MAX
+				};
+				std::memcpy(b, header, sizeof(header));
+				uint32_t const *const first = v.block_begin(blk);
+				std::copy(first, v.block_end(blk), b + HEADER);
+			}
+			return aligned_words(blocks.data(), blocks.data() + blocks.size());
+		}
+
+		uint32_t const *block(uint64_t const pos) const
+		{
+			return m_blocks.data() + pos * STRIDE;
+		}
+
+		static uint64_t bits_before(uint32_t const *const b)
+		{
+			uint64_t x;
+			std::memcpy(&x, b, 8);
+			return x;
+		}
+
+		static uint64_t ones_before(uint32_t const *const b)
+		{
+			uint64_t x;
+			std::memcpy(&x, b + 2, 8);
+			return x;
+		}
+
+		static uint64_t bits_after(uint32_t const *const b)
+		{
+			uint64_t x;
+			std::memcpy(&x, b + 4, 8);
+			return x;
+		}
+
+		static uint64_t ones_after(uint32_t const *const b)
+		{
+			uint64_t x;
+			std::memcpy(&x, b + 6, 8);
+			return x;
+		}
+
+		uint64_t block_words(uint64_t const pos) const
+		{
+			return std::min<uint64_t>(s18_seq_size - std::min<uint64_t>(pos * b_s, s18_seq_size), b_s);
+		}
+
+		/* Last block starting at or before bit `key`, walking the headers from its l2 sample */
+		uint64_t block_by_bits(uint64_t const key) const
+		{
+			uint64_t pos = l2_bits[std::min<uint64_t>(key / l2_bits_div, l2_bits.size() - 1)] - 1;
+			while (bits_after(block(pos)) <= key) pos++;
+			return pos;
+		}
+
+		/* Block holding the `key`-th 1 bit, same as above */
+		uint64_t block_by_ones(uint64_t const key) const
+		{
+			uint64_t pos = l2_ones[std::min<uint64_t>(key / l2_ones_div, l2_ones.size() - 1)] - 1;
+			while (ones_after(block(pos)) < key) pos++;
+			return pos;
+		}
+
+	public:
+		blocked_vector(void)=delete;
+
+		template<class vector_type>
+		blocked_vector(vector<b_s, vector_type, summary_type> const &v)
+			: m_ones(v.m_ones)
+			, m_size(v.m_size)
+			, s18_seq_size(v.s18_seq_size)
+			, m_blocks(lay_out(v))
+			, l2_bits(v.l2_bits.size(), 0)
+			, l2_ones(v.l2_ones.size(), 0)
+			, l2_bits_div(v.l2_bits_div)
+			, l2_ones_div(v.l2_ones_div)
+			, m_summary(v.m_summary)
+		{
+			for (uint64_t i = 0; i < l2_bits.size(); i++) {
+				l2_bits[i] = v.l2_bits[i];
+				l2_ones[i] = v.l2_ones[i];
+			}
+			util::bit_compress(l2_bits);
+			util::bit_compress(l2_ones);
+		} /* end blocked_vector::blocked_vector */
+
+		blocked_vector(bit_vector const &bv)
+			: blocked_vector(words_of(bv))
+		{} /* end blocked_vector::blocked_vector */
+
+		/* Constructor from a file written by serialize() */
+		explicit blocked_vector(std::string const &file)
+			: m_ones(0)
+			, m_size(0)
+			, s18_seq_size(0)
+			, m_blocks()
+			, l2_bits()
+			, l2_ones()
+			, l2_bits_div(1)
+			, l2_ones_div(1)
+			, m_summary()
+		{
+			std::ifstream in(file, std::ios::binary);
+			if (not in)
+				throw std::invalid_argument("blocked_vector::blocked_vector: cannot open " + file);
+			load(in);
+			if (not in)
+				throw std::invalid_argument("blocked_vector::blocked_vector: " + file + " is truncated or holds no blocked_vector");
+		} /* end blocked_vector::blocked_vector */
+
+		uint64_t size(void) const
+		{
+			return m_size;
+		}
+
+		uint64_t ones(void) const
+		{
+			return m_ones;
+		}
+
+		aligned_words const &data(void) const
+		{
+			return m_blocks;
+		}
+
+		/* Bit at key, like vector::operator[] */
+		uint64_t operator[](uint64_t const key) const
+		{
+			uint64_t const pos = block_by_bits(key);
+			uint32_t const *const b = block(pos);
+			uint64_t const n = block_words(pos);
+			uint64_t const target = key - bits_before(b);
+
+			uint64_t accum = -1;
+			uint64_t ones = 0;
+			uint64_t const w = m_summary.skip_bits(b + HEADER, pos * b_s, n, target, accum, ones);
+			return w == n ? 0 : words_of::word_access(b[HEADER + w], target - accum);
+		}
+
+		/* 1 bits before key, like rank_support<1> */
+		uint64_t rank(uint64_t const key) const
+		{
+			uint64_t const pos = block_by_bits(key);
+			uint32_t const *const b = block(pos);
+			uint64_t const n = block_words(pos);
+			uint64_t const target = key - bits_before(b);
+
+			uint64_t accum = -1;
+			uint64_t ones = 0;
+			uint64_t const w = m_summary.skip_bits(b + HEADER, pos * b_s, n, target, accum, ones);
+			ones += ones_before(b);
+			return w == n ? ones : ones + words_of::word_rank(b[HEADER + w], target - accum);
+		}
+
+		/* Position after the `key`-th 1 bit, like select_support<1> */
+		uint64_t select(uint64_t const key) const
+		{
+			uint64_t const pos = block_by_ones(key);
+			uint32_t const *const b = block(pos);
+			uint64_t const n = block_words(pos);
+
+			uint64_t counter = key - ones_before(b);
+			uint64_t accum = 0;
+			uint64_t const w = m_summary.skip_ones(b + HEADER, pos * b_s, n, counter, accum);
+			uint64_t const p = bits_before(b) + accum;
+			return counter ? p + words_of::word_select(b[HEADER + w], counter) : p;
+		}
+
+		uint64_t serialize(std::ostream& out, structure_tree_node* v=nullptr, std::string name="") const
+		{
+			structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
+
+			uint64_t written_bytes = 0;
+			written_bytes += write_member(m_ones, out, child, "m_ones");
+			written_bytes += write_member(m_size, out, child, "m_size");
+			written_bytes += write_member(s18_seq_size, out, child, "s18_seq_size");
+			written_bytes += write_member(l2_bits_div, out, child, "l2_bits_div");
+			written_bytes += write_member(l2_ones_div, out, child, "l2_ones_div");
+
+			written_bytes += m_blocks.serialize(out, child, "m_blocks");
+			written_bytes += l2_bits.serialize(out, child, "l2_bits");
+			written_bytes += l2_ones.serialize(out, child, "l2_ones");
+			written_bytes += m_summary.serialize(out, child, "m_summary");
+
+			structure_tree::add_size(child, written_bytes);
+
+			return written_bytes;
+		}
+
+		/* Read back what serialize() wrote */
+		void load(std::istream &in)
+		{
+			read_member(m_ones, in);
+			read_member(m_size, in);
+			read_member(s18_seq_size, in);
+			read_member(l2_bits_div, in);
+			read_member(l2_ones_div, in);
+
+			m_blocks.load(in);
+			l2_bits.load(in);
+			l2_ones.load(in);
+			m_summary.load(in);
+
+			if (m_blocks.size() == 0 or m_blocks.size() % STRIDE or l2_bits.size() == 0 or l2_ones.size() == 0)
+				in.setstate(std::ios::failbit);
+		}
+};
+
+
+/*
+ * Intersection
+ *
+ * Walks the 1 bits of the vector holding fewer of them and skips the
+ * other one to each. skip_to() crosses whole blocks through the samples
+ * and whole words through the summary, so only the words around the
+ * candidates get decoded.
+ */
+template<uint16_t b_s, class vector_type, class summary_type, class function>
+void intersect_each(vector<b_s, vector_type, summary_type> const &a, vector<b_s, vector_type, summary_type> const &b, function f)
+{
+	bool const a_shorter = a.ones() <= b.ones();
+	vector<b_s, vector_type, summary_type> const &shorter = a_shorter ? a : b;
+	vector<b_s, vector_type, summary_type> const &longer = a_shorter ? b : a;
+
+	auto s = shorter.begin_ones();
+	auto l = longer.begin_ones();
+	auto const s_end = shorter.end_ones();
+	auto const l_end = longer.end_ones();
+	for (; s != s_end; ++s) {
+		l.skip_to(*s);
+		if (l == l_end) return;
+		if (*l == *s) f(*s);
+	}
+}
+
+/* Write the positions of the 1 bits common to a and b to out, in order */
+template<uint16_t b_s, class vector_type, class summary_type, class output_iterator>
+output_iterator intersect(vector<b_s, vector_type, summary_type> const &a, vector<b_s, vector_type, summary_type> const &b, output_iterator out)
+{
+	intersect_each(a, b, [&out](uint64_t const p) { *out++ = p; });
+	return out;
+}
+
+/* Number of 1 bits common to a and b */
+template<uint16_t b_s, class vector_type, class summary_type>
+uint64_t intersect_count(vector<b_s, vector_type, summary_type> const &a, vector<b_s, vector_type, summary_type> const &b)
+{
+	uint64_t count = 0;
+	intersect_each(a, b, [&count](uint64_t) { count++; });
+	return count;
+}
+
+
+/*
+ * Union
+ *
+ * Merges the 1 bits of the inputs through a heap holding the next one of
+ * each and feeds them to a builder, so the result is encoded as it is
+ * produced and no bit vector is ever materialized. The result is as long
+ * as the longest input.
+ */
+template<uint16_t b_s, class vector_type, class summary_type>
+vector<b_s, vector_type, summary_type> unite(std::vector<vector<b_s, vector_type, summary_type> const *> const &inputs)
+{
+	typedef typename vector<b_s, vector_type, summary_type>::const_one_iterator one_iterator;
+	typedef std::pair<uint64_t, uint64_t> head;  // Next 1 bit and its input
+
+	uint64_t size = 0;
+	std::vector<one_iterator> ones;
+	std::priority_queue<head, std::vector<head>, std::greater<head>> heap;
+	for (uint64_t i = 0; i < inputs.size(); i++) {
+		size = std::max(size, inputs[i]->size());
+		ones.push_back(inputs[i]->begin_ones());
+		if (*ones[i] < inputs[i]->size())
+			heap.emplace(*ones[i], i);
+	}
+
+	builder<b_s, vector_type, summary_type> b(size);
+	uint64_t next = 0;  // Lowest position not pushed yet
+	while (not heap.empty()) {
+		head const top = heap.top();
+		heap.pop();
+		if (top.first >= next) {
+			b.push_back(top.first);
+			next = top.first + 1;
+		}
+
+		one_iterator &it = ++ones[top.second];
+		if (*it < inputs[top.second]->size())
+			heap.emplace(*it, top.second);
+	}
+	return b.build();
+}
+
+template<uint16_t b_s, class vector_type, class summary_type>
+vector<b_s, vector_type, summary_type> unite(vector<b_s, vector_type, summary_type> const &a, vector<b_s, vector_type, summary_type> const &b)
+{
+	return unite(std::vector<vector<b_s, vector_type, summary_type> const *>{&a, &b});
+}
+
+
+/*
+ * Shared memory
+ *
+ * publish() places a vector in a POSIX shared memory segment, laid out as
+ * described by shared_header. Any process may then attach() to it and
+ * query the words and samples in place, read only, with every support.
+ * The segment lives until unpublish(), and after it for as long as some
+ * process keeps it attached.
+ */
+template<uint16_t b_s, class vector_type, class summary_type>
+void publish(vector<b_s, vector_type, summary_type> const &v, std::string const &name)
+{
+	uint64_t const bytes = size_in_bytes(v);
+	shared_segment segment(name, sizeof(shared_header) + bytes);
+
+	byte_buffer buffer(segment.data() + sizeof(shared_header), segment.data() + segment.size());
+	std::ostream out(&buffer);
+	v.serialize(out);
+	if (not out or buffer.written() != bytes) {
+		segment.discard();
+		throw std::invalid_argument("publish: vector did not serialize to its size");
+	}
+
+	shared_header header = {0, b_s, bytes, {}};
+	std::string const summary = util::class_name(summary_type());
+	std::memcpy(header.summary, summary.data(), std::min(summary.size(), sizeof(header.summary) - 1));
+	std::memcpy(segment.data(), &header, sizeof(header));
+	__atomic_store_n(reinterpret_cast<uint64_t *>(segment.data()), SHARED_MAGIC, __ATOMIC_RELEASE);
+}
+
+/* View of the vector published as `name`, which must have the same b_s and summary_type and compact samples */
+template<uint16_t b_s = 256, class summary_type = no_summary>
+mapped_vector<b_s, summary_type> attach(std::string const &name)
+{
+	std::shared_ptr<mapping const> m = std::make_shared<mapping const>(name, true);
+	if (m->size() < sizeof(shared_header)
+			or __atomic_load_n(reinterpret_cast<uint64_t const *>(m->data()), __ATOMIC_ACQUIRE) != SHARED_MAGIC)
+		throw std::invalid_argument("attach: " + name + " does not hold a published vector");
+
+	shared_header header;
+	std::memcpy(&header, m->data(), sizeof(header));
+	std::string const summary = util::class_name(summary_type());
+	if (header.block_size != b_s)
+		throw std::invalid_argument("attach: " + name + " was published with another block size");
+	if (summary.compare(0, sizeof(header.summary) - 1, header.summary) != 0)
+		throw std::invalid_argument("attach: " + name + " was published with another summary");
+	if (header.bytes > m->size() - sizeof(header))
+		throw std::invalid_argument("attach: " + name + " is shorter than what was serialized");
+
+	return mapped_vector<b_s, summary_type>(std::move(m), sizeof(header));
+}
+
+/* Remove the segment published as `name` */
+inline void unpublish(std::string const &name)
+{
+	if (::shm_unlink(name.c_str()) < 0)
+		throw std::system_error(errno, std::generic_category(), "unpublish: cannot remove " + name);
+}
 
 } /* namespace s18 */
 } /* namespace sdsl */
@@ -0,0 +1,961 @@
+/*
+ * storage: Where S18 compressed bitvectors keep their words and samples
+ * Copyright (C) 2019  Manuel Weitzman
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDED_SDSL_S18_STORAGE
+#define INCLUDED_SDSL_S18_STORAGE
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <istream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <sdsl/int_vector.hpp>
+#include <sdsl/util.hpp>
+
+
+namespace sdsl
+{
+namespace s18
+{
+
+/*
+ * Mappings
+ *
+ * A file, or a POSIX shared memory segment, mapped read only for as long
+ * as some view points into it. Views keep a shared pointer to their
+ * mapping, so copies of a mapped vector share it and the last one to go
+ * unmaps it.
+ */
+class mapping
+{
+	private:
+		char const *m_data;
+		uint64_t    m_size;
+
+		/* Map all of fd, which is closed either way */
+		void map(int const fd, std::string const &what)
+		{
+			if (fd < 0)
+				throw std::system_error(errno, std::generic_category(), "mapping::mapping: cannot open " + what);
+
+			struct stat st;
+			if (::fstat(fd, &st) < 0) {
+				int const err = errno;
+				::close(fd);
+				throw std::system_error(err, std::generic_category(), "mapping::mapping: cannot stat " + what);
+			}
+			m_size = static_cast<uint64_t>(st.st_size);
+
+			if (m_size) {
+				void *const p = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+				if (p == MAP_FAILED) {
+					int const err = errno;
+					::close(fd);
+					throw std::system_error(err, std::generic_category(), "mapping::mapping: cannot map " + what);
+				}
+				m_data = static_cast<char const *>(p);
+			}
+			::close(fd);
+		}
+
+	public:
+		/* Map a file; with `shared`, the shared memory segment of that name */
+		mapping(std::string const &file, bool const shared = false)
+			: m_data(nullptr)
+			, m_size(0)
+		{
+			map(shared ? ::shm_open(file.c_str(), O_RDONLY, 0) : ::open(file.c_str(), O_RDONLY), file);
+		} /* end mapping::mapping */
+
+		mapping(mapping const &)=delete;
+		mapping &operator=(mapping const &)=delete;
+
+		~mapping(void)
+		{
+			if (m_data)
+				::munmap(const_cast<char *>(m_data), m_size);
+		} /* end mapping::~mapping */
+
+		char const *data(void) const
+		{
+			return m_data;
+		}
+
+		uint64_t size(void) const
+		{
+			return m_size;
+		}
+};
+
+/* 32 bit words of a mapping, laid out as int_vector<32> serializes them */
+class mapped_words
+{
+	public:
+		typedef uint32_t        value_type;
+		typedef uint64_t        size_type;
+		typedef uint32_t const *iterator;
+		typedef uint32_t const *const_iterator;
+
+	private:
+		std::shared_ptr<mapping const> m_map;
+		uint32_t const                *m_data;
+		uint64_t                       m_size;
+
+	public:
+		mapped_words(void)
+			: m_map()
+			, m_data(nullptr)
+			, m_size(0)
+		{}
+
+		mapped_words(mapped_words const &)=default;
+		mapped_words &operator=(mapped_words const &)=default;
+
+		mapped_words(std::shared_ptr<mapping const> map, char const *data, uint64_t const size)
+			: m_map(std::move(map))
+			, m_data(reinterpret_cast<uint32_t const *>(data))
+			, m_size(size)
+		{}
+
+		uint64_t size(void) const { return m_size; }
+		uint8_t width(void) const { return 32; }
+		uint32_t const *data(void) const { return m_data; }
+		const_iterator begin(void) const { return m_data; }
+		const_iterator end(void) const { return m_data + m_size; }
+		uint32_t operator[](uint64_t const i) const { return m_data[i]; }
+
+		uint64_t serialize(std::ostream &out, structure_tree_node *v = nullptr, std::string name = "") const
+		{
+			uint64_t const bits = m_size * 32;
+			uint64_t written_bytes = write_member(bits, out, v, name);
+			out.write(reinterpret_cast<char const *>(m_data), static_cast<std::streamsize>((bits + 63) / 64 * 8));
+			return written_bytes + (bits + 63) / 64 * 8;
+		}
+};
+
+/* Bit compressed integers of a mapping, laid out as int_vector<> serializes them */
+class mapped_samples
+{
+	public:
+		typedef uint64_t value_type;
+		typedef uint64_t size_type;
+
+	private:
+		std::shared_ptr<mapping const> m_map;
+		char const                    *m_data;  // Not aligned, the width comes before it
+		uint64_t                       m_size;
+		uint8_t                        m_width;
+
+		uint64_t word(uint64_t const i) const
+		{
+			uint64_t w;
+			std::memcpy(&w, m_data + i * 8, 8);
+			return w;
+		}
+
+	public:
+		mapped_samples(void)
+			: m_map()
+			, m_data(nullptr)
+			, m_size(0)
+			, m_width(64)
+		{}
+
+		mapped_samples(mapped_samples const &)=default;
+		mapped_samples &operator=(mapped_samples const &)=default;
+
+		mapped_samples(std::shared_ptr<mapping const> map, char const *data, uint64_t const size, uint8_t const width)
+			: m_map(std::move(map))
+			, m_data(data)
+			, m_size(size)
+			, m_width(width)
+		{}
+
+		uint64_t size(void) const { return m_size; }
+		uint8_t width(void) const { return m_width; }
+		char const *data(void) const { return m_data; }
+
+		uint64_t operator[](uint64_t const i) const
+		{
+			uint64_t const bit = i * m_width;
+			uint64_t const offset = bit % 64;
+			uint64_t value = word(bit / 64) >> offset;
+			if (offset + m_width > 64)
+				value |= word(bit / 64 + 1) << (64 - offset);
+			return m_width == 64 ? value : value & ((uint64_t(1) << m_width) - 1);
+		}
+
+		uint64_t serialize(std::ostream &out, structure_tree_node *v = nullptr, std::string name = "") const
+		{
+			uint64_t const bits = m_size * m_width;
+			uint64_t written_bytes = write_member(bits, out, v, name);
+			written_bytes += write_member(m_width, out, v, name);
+			out.write(m_data, static_cast<std::streamsize>((bits + 63) / 64 * 8));
+			return written_bytes + (bits + 63) / 64 * 8;
+		}
+};
+
+/* Stream buffer over a fixed range of bytes, to serialize into or load from */
+class byte_buffer : public std::streambuf
+{
+	public:
+		byte_buffer(char *begin, char *end)
+		{
+			setg(begin, begin, end);
+			setp(begin, end);
+		}
+
+		uint64_t consumed(void) const
+		{
+			return static_cast<uint64_t>(gptr() - eback());
+		}
+
+		uint64_t written(void) const
+		{
+			return static_cast<uint64_t>(pptr() - pbase());
+		}
+};
+
+/*
+ * Reads what a serialize() wrote, in the same order, out of a mapping.
+ * Words and samples are viewed in place; anything else is loaded from a
+ * stream over the bytes left.
+ */
+class mapped_reader
+{
+	private:
+		std::shared_ptr<mapping const> m_map;
+		uint64_t                       m_offset;
+
+		char const *take(uint64_t const n)
+		{
+			if (n > m_map->size() - m_offset)
+				throw std::invalid_argument("mapped_reader: file is shorter than what was serialized");
+			char const *const p = m_map->data() + m_offset;
+			m_offset += n;
+			return p;
+		}
+
+	public:
+		mapped_reader(std::shared_ptr<mapping const> map, uint64_t const offset = 0)
+			: m_map(std::move(map))
+			, m_offset(offset)
+		{
+			if (m_offset > m_map->size())
+				throw std::invalid_argument("mapped_reader: file is shorter than what was serialized");
+		}
+
+		template<class T>
+		void member(T &t)
+		{
+			std::memcpy(&t, take(sizeof(T)), sizeof(T));
+		}
+
+		void words(mapped_words &w)
+		{
+			uint64_t bits;
+			member(bits);
+			if (bits % 32)
+				throw std::invalid_argument("mapped_reader: words are not 32 bits wide");
+			char const *const data = take((bits + 63) / 64 * 8);
+			if (reinterpret_cast<uintptr_t>(data) % 4)
+				throw std::invalid_argument("mapped_reader: words are not aligned");
+			w = mapped_words(m_map, data, bits / 32);
+		}
+
+		void samples(mapped_samples &s)
+		{
+			uint64_t bits;
+			uint8_t width;
+			member(bits);
+			member(width);
+			if (width == 0 or width > 64 or bits % width)
+				throw std::invalid_argument("mapped_reader: samples have an invalid width");
+			s = mapped_samples(m_map, take((bits + 63) / 64 * 8), bits / width, width);
+		}
+
+		/* Copy t onto the heap through its load(), for members with no view such as summaries */
+		template<class T>
+		void load(T &t)
+		{
+			/* The buffer is only read from */
+			byte_buffer buffer(
+				const_cast<char *>(m_map->data() + m_offset),
+				const_cast<char *>(m_map->data() + m_map->size())
+			);
+			std::istream in(&buffer);
+			t.load(in);
+			if (not in)
+				throw std::invalid_argument("mapped_reader: file is shorter than what was serialized");
+			m_offset += buffer.consumed();
+		}
+};
+
+
+/*
+ * Shared memory segments
+ *
+ * A segment holds a 64 byte header describing the vector, then what its
+ * serialize() writes. The header is written last and its magic number
+ * last of all, so a process attaching while the segment is being filled
+ * sees no magic number rather than half a vector.
+ */
+struct shared_header
+{
+	uint64_t magic;       // SHARED_MAGIC once the segment is complete
+	uint64_t block_size;  // b_s of the vector
+	uint64_t bytes;       // Bytes serialized after the header
+	char     summary[40]; // Class name of its summary, cut to fit
+};
+static_assert(sizeof(shared_header) == 64, "shared_header: must fill a cache line");
+
+static uint64_t constexpr SHARED_MAGIC = 0x31305636314D4853;  // "SHM16V01"
+
+/* Segment created to be filled, mapped writable until this goes away */
+class shared_segment
+{
+	private:
+		std::string m_name;
+		char       *m_data;
+		uint64_t    m_size;
+
+	public:
+		/* Create segment `name` of `size` bytes; it must not exist yet */
+		shared_segment(std::string const &name, uint64_t const size)
+			: m_name(name)
+			, m_data(nullptr)
+			, m_size(size)
+		{
+			int const fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+			if (fd < 0)
+				throw std::system_error(errno, std::generic_category(), "shared_segment::shared_segment: cannot create " + name);
+
+			void *p = MAP_FAILED;
+			if (::ftruncate(fd, static_cast<off_t>(size)) == 0)
+				p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			int const err = errno;
+			::close(fd);
+			if (p == MAP_FAILED) {
+				::shm_unlink(name.c_str());
+				throw std::system_error(err, std::generic_category(), "shared_segment::shared_segment: cannot size " + name);
+			}
+			m_data = static_cast<char *>(p);
+		} /* end shared_segment::shared_segment */
+
+		shared_segment(shared_segment const &)=delete;
+		shared_segment &operator=(shared_segment const &)=delete;
+
+		~shared_segment(void)
+		{
+			::munmap(m_data, m_size);
+		} /* end shared_segment::~shared_segment */
+
+		char *data(void)
+		{
+			return m_data;
+		}
+
+		uint64_t size(void) const
+		{
+			return m_size;
+		}
+
+		/* Remove the segment, for when filling it failed */
+		void discard(void)
+		{
+			::shm_unlink(m_name.c_str());
+		}
+};
+
+
+/*
+ * Buffers
+ *
+ * Where owned_words gets its memory from. allocate() returns at least
+ * `bytes` bytes, which release() is given back along with the same count.
+ */
+
+/* Aligned to cache lines, so no block straddles one more than it must */
+struct cache_lines
+{
+	static uint64_t constexpr ALIGN = 64;
+
+	static void *allocate(uint64_t const bytes)
+	{
+		void *const p = std::aligned_alloc(ALIGN, std::max<uint64_t>((bytes + ALIGN - 1) / ALIGN * ALIGN, ALIGN));
+		if (not p)
+			throw std::bad_alloc();
+		return p;
+	}
+
+	static void release(void *const p, uint64_t)
+	{
+		std::free(p);
+	}
+};
+
+/*
+ * Backed by 2 MB pages where the kernel has transparent huge pages, which
+ * takes most TLB misses off random queries on vectors of several GB.
+ * Buffers under a page are not worth one and come from cache_lines.
+ */
+struct huge_pages
+{
+	static uint64_t constexpr PAGE = uint64_t(2) << 20;
+
+	static void *allocate(uint64_t const bytes)
+	{
+		if (bytes < PAGE)
+			return cache_lines::allocate(bytes);
+
+		/* Map a page more than needed and trim it to a page boundary */
+		uint64_t const size = (bytes + PAGE - 1) / PAGE * PAGE;
+		void *const p = ::mmap(nullptr, size + PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (p == MAP_FAILED)
+			throw std::bad_alloc();
+		char *const raw = static_cast<char *>(p);
+		char *const aligned = raw + (PAGE - reinterpret_cast<uintptr_t>(raw) % PAGE) % PAGE;
+		if (aligned != raw)
+			::munmap(raw, static_cast<uint64_t>(aligned - raw));
+		::munmap(aligned + size, PAGE - static_cast<uint64_t>(aligned - raw));
+#ifdef MADV_HUGEPAGE
+		::madvise(aligned, size, MADV_HUGEPAGE);  /* Only a hint, pages stay small without THP */
+#endif
+		return aligned;
+	}
+
+	static void release(void *const p, uint64_t const bytes)
+	{
+		if (bytes < PAGE)
+			cache_lines::release(p, bytes);
+		else
+			::munmap(p, (bytes + PAGE - 1) / PAGE * PAGE);
+	}
+};
+
+/* 32 bit words in a plain buffer from `buffer`, serialized like int_vector<32> */
+template<class buffer>
+class owned_words
+{
+	public:
+		typedef uint32_t        value_type;
+		typedef uint64_t        size_type;
+		typedef uint32_t const *iterator;
+		typedef uint32_t const *const_iterator;
+
+	private:
+		uint32_t *m_data;
+		uint64_t  m_size;
+
+		/* Bytes held, rounded up to whole 64 bit words as int_vector<32> does */
+		static uint64_t bytes(uint64_t const size)
+		{
+			return (size * 32 + 63) / 64 * 8;
+		}
+
+		void reset(uint64_t const size)
+		{
+			if (m_data)
+				buffer::release(m_data, bytes(m_size));
+			m_data = static_cast<uint32_t *>(buffer::allocate(bytes(size)));
+			m_size = size;
+			std::memset(m_data, 0, bytes(size));
+		}
+
+	public:
+		owned_words(void)
+			: m_data(nullptr)
+			, m_size(0)
+		{
+			reset(0);
+		} /* end owned_words::owned_words */
+
+		owned_words(uint32_t const *first, uint32_t const *last)
+			: m_data(nullptr)
+			, m_size(0)
+		{
+			reset(static_cast<uint64_t>(last - first));
+			std::copy(first, last, m_data);
+		} /* end owned_words::owned_words */
+
+		owned_words(owned_words const &other)
+			: owned_words(other.begin(), other.end())
+		{} /* end owned_words::owned_words */
+
+		owned_words(owned_words &&other)
+			: m_data(other.m_data)
+			, m_size(other.m_size)
+		{
+			other.m_data = nullptr;
+			other.m_size = 0;
+		} /* end owned_words::owned_words */
+
+		owned_words &operator=(owned_words other)
+		{
+			std::swap(m_data, other.m_data);
+			std::swap(m_size, other.m_size);
+			return *this;
+		}
+
+		~owned_words(void)
+		{
+			if (m_data)
+				buffer::release(m_data, bytes(m_size));
+		} /* end owned_words::~owned_words */
+
+		uint64_t size(void) const { return m_size; }
+		uint8_t width(void) const { return 32; }
+		uint32_t const *data(void) const { return m_data; }
+		const_iterator begin(void) const { return m_data; }
+		const_iterator end(void) const { return m_data + m_size; }
+		uint32_t operator[](uint64_t const i) const { return m_data[i]; }
+
+		bool operator==(owned_words const &other) const
+		{
+			return m_size == other.m_size and std::equal(begin(), end(), other.begin());
+		}
+
+		uint64_t serialize(std::ostream &out, structure_tree_node *v = nullptr, std::string name = "") const
+		{
+			uint64_t const bits = m_size * 32;
+			uint64_t written_bytes = write_member(bits, out, v, name);
+			out.write(reinterpret_cast<char const *>(m_data), static_cast<std::streamsize>(bytes(m_size)));
+			return written_bytes + bytes(m_size);
+		}
+
+		void load(std::istream &in)
+		{
+			uint64_t bits = 0;
+			read_member(bits, in);
+			reset(bits / 32);
+			in.read(reinterpret_cast<char *>(m_data), static_cast<std::streamsize>(bytes(m_size)));
+		}
+};
+
+typedef owned_words<cache_lines> aligned_words;
+typedef owned_words<huge_pages>  huge_words;
+
+
+/*
+ * Two level counters
+ *
+ * Block samples as fixed width integers, laid out like rank_support_v
+ * lays out its counts. Every cache line starts with a 64 bit absolute
+ * value per column, then holds each column's counts relative to it: 16
+ * bits wide when every line allows it, 32 bits otherwise and 64 as a
+ * last resort. A lookup is a shift, two aligned loads and an add, where
+ * a bit compressed int_vector<> extracts a field that may cross a word
+ * boundary. Columns laid out together, such as the bits and the 1 bits
+ * before each block, share their lines, so reading both touches one.
+ * A counters object views one column of lines shared with the others.
+ */
+class counters
+{
+	public:
+		typedef uint64_t value_type;
+		typedef uint64_t size_type;
+
+	private:
+		static uint64_t constexpr LINE = 64;
+
+		std::shared_ptr<char> m_data;
+		uint64_t              m_size;
+		uint8_t               m_columns;   // Laid out in each line
+		uint8_t               m_column;    // Viewed by this object
+		uint8_t               m_width;     // Of the relative counts
+		uint8_t               m_shift;     // log2 of the counts per line
+		uint64_t              m_relative;  // Bytes of each column's counts in a line
+
+		uint64_t lines(void) const
+		{
+			return std::max<uint64_t>((m_size + (uint64_t(1) << m_shift) - 1) >> m_shift, 1);
+		}
+
+		/* Lay out `columns` columns of `size` counts, `width` bits wide */
+		void shape(uint64_t const size, uint8_t const columns, uint8_t const width)
+		{
+			m_size = size;
+			m_columns = columns;
+			m_column = 0;
+			m_width = width;
+			m_relative = uint64_t(1) << bits::hi((LINE - 8 * columns) / columns);
+			m_shift = static_cast<uint8_t>(bits::hi(m_relative * 8 / width));
+		}
+
+		/* Zeroed lines for the current layout */
+		char *allocate(void)
+		{
+			char *const data = static_cast<char *>(cache_lines::allocate(lines() * LINE));
+			std::memset(data, 0, lines() * LINE);
+			m_data = std::shared_ptr<char>(data, [](char *const p) { cache_lines::release(p, 0); });
+			return data;
+		}
+
+		template<class t_int>
+		uint64_t get(uint64_t const i) const
+		{
+			char const *const line = m_data.get() + (i >> m_shift) * LINE;
+			uint64_t base;
+			t_int rel;
+			std::memcpy(&base, line + 8 * m_column, 8);
+			std::memcpy(&rel, line + 8 * m_columns + m_column * m_relative + (i & ((uint64_t(1) << m_shift) - 1)) * sizeof(t_int), sizeof(t_int));
+			return base + rel;
+		}
+
+		template<class t_int>
+		static void put(char *const p, uint64_t const x)
+		{
+			t_int const y = static_cast<t_int>(x);
+			std::memcpy(p, &y, sizeof(t_int));
+		}
+
+		/* Largest difference between two values sharing a line */
+		template<class t_vector>
+		static uint64_t spread(t_vector const &v, uint64_t const per_line)
+		{
+			uint64_t most = 0;
+			for (uint64_t i = 0; i < v.size(); i += per_line) {
+				uint64_t lo = -1, hi = 0;
+				for (uint64_t j = i; j < std::min<uint64_t>(i + per_line, v.size()); j++) {
+					lo = std::min<uint64_t>(lo, v[j]);
+					hi = std::max<uint64_t>(hi, v[j]);
+				}
+				most = std::max(most, hi - lo);
+			}
+			return most;
+		}
+
+		/* Lay the columns out together, each line relative to its least values */
+		template<class t_vector>
+		void build(std::initializer_list<t_vector const *> const columns)
+		{
+			uint64_t const size = (*columns.begin())->size();
+			uint8_t const n = static_cast<uint8_t>(columns.size());
+
+			/* Narrowest width every line of every column fits in */
+			uint8_t width = 64;
+			for (uint64_t const w : {32, 16}) {
+				shape(size, n, static_cast<uint8_t>(w));
+				bool fits = true;
+				for (t_vector const *v : columns)
+					fits = fits and spread(*v, uint64_t(1) << m_shift) < (uint64_t(1) << w);
+				if (fits)
+					width = static_cast<uint8_t>(w);
+			}
+
+			shape(size, n, width);
+			char *const data = allocate();
+			uint64_t col = 0;
+			for (t_vector const *v : columns) {
+				for (uint64_t l = 0; (l << m_shift) < size; l++) {
+					uint64_t const first = l << m_shift;
+					uint64_t const last = std::min<uint64_t>(first + (uint64_t(1) << m_shift), size);
+					uint64_t lo = -1;
+					for (uint64_t j = first; j < last; j++)
+						lo = std::min<uint64_t>(lo, (*v)[j]);
+					std::memcpy(data + l * LINE + 8 * col, &lo, 8);
+
+					char *const rel = data + l * LINE + 8 * n + col * m_relative;
+					for (uint64_t j = first; j < last; j++) {
+						switch (m_width) {
+							case 16: put<uint16_t>(rel + (j - first) * 2, (*v)[j] - lo); break;
+							case 32: put<uint32_t>(rel + (j - first) * 4, (*v)[j] - lo); break;
+							default: put<uint64_t>(rel + (j - first) * 8, (*v)[j] - lo); break;
+						}
+					}
+				}
+				col++;
+			}
+		}
+
+	public:
+		counters(void)
+			: m_data()
+			, m_size(0)
+			, m_columns(1)
+			, m_column(0)
+			, m_width(16)
+			, m_shift(0)
+			, m_relative(0)
+		{
+			shape(0, 1, 16);
+			allocate();
+		} /* end counters::counters */
+
+		/* Counters holding v, alone in their lines */
+		template<class t_vector>
+		explicit counters(t_vector const &v)
+			: counters()
+		{
+			build({&v});
+		} /* end counters::counters */
+
+		/* Counters holding a and b, as long as a, sharing their lines */
+		template<class t_vector>
+		static void interleave(t_vector const &a, t_vector const &b, counters &in_a, counters &in_b)
+		{
+			counters c;
+			c.build({&a, &b});
+			in_a = c.column(0);
+			in_b = c.column(1);
+		}
+
+		/* View of column k of the same lines */
+		counters column(uint8_t const k) const
+		{
+			if (k >= m_columns)
+				throw std::invalid_argument("counters::column: no such column");
+			counters c(*this);
+			c.m_column = k;
+			return c;
+		}
+
+		uint8_t columns(void) const { return m_columns; }
+
+		uint64_t size(void) const { return m_size; }
+
+		uint64_t operator[](uint64_t const i) const
+		{
+			/* Past the last counter lies the next line, or the end of the buffer */
+			assert(i < m_size);
+			switch (m_width) {
+				case 16: return get<uint16_t>(i);
+				case 32: return get<uint32_t>(i);
+				default: return get<uint64_t>(i);
+			}
+		}
+
+		/* Address of the line holding counter i, to prefetch it */
+		char const *line(uint64_t const i) const
+		{
+			return m_data.get() + (i >> m_shift) * LINE;
+		}
+
+		/* Writes the lines, with every column in them, from the first column only */
+		uint64_t serialize(std::ostream &out, structure_tree_node *v = nullptr, std::string name = "") const
+		{
+			if (m_column)
+				return 0;
+			uint64_t written_bytes = write_member(m_size, out, v, name);
+			written_bytes += write_member(m_columns, out, v, name);
+			written_bytes += write_member(m_width, out, v, name);
+			out.write(m_data.get(), static_cast<std::streamsize>(lines() * LINE));
+			return written_bytes + lines() * LINE;
+		}
+
+		/* Reads back the lines as serialize() wrote them, viewing their first column */
+		void load(std::istream &in)
+		{
+			uint64_t size = 0;
+			uint8_t columns = 1;
+			uint8_t width = 16;
+			read_member(size, in);
+			read_member(columns, in);
+			read_member(width, in);
+			if ((width != 16 and width != 32 and width != 64) or columns == 0 or columns > 4) {
+				in.setstate(std::ios::failbit);
+				size = 0, columns = 1, width = 16;
+			}
+			shape(size, columns, width);
+			in.read(allocate(), static_cast<std::streamsize>(lines() * LINE));
+		}
+};
+
+
+/*
+ * Sample policies
+ *
+ * How a storage keeps block samples. sampled() turns one computed sample
+ * vector into the samples type; sampled_blocks() does it for the bits
+ * and the 1 bits before each block, read together by every query, which
+ * serialize_blocks() and load_blocks() write and read back together.
+ * LAYOUT tags what they write, so a vector serialized with one policy is
+ * never read with another.
+ */
+
+/* Bit compressed int_vector<>s, each on its own */
+struct compact_samples
+{
+	typedef int_vector<> samples;
+	static uint64_t constexpr LAYOUT = 1;
+
+	static samples sampled(int_vector<> &&v)
+	{
+		util::bit_compress(v);
+		return std::move(v);
+	}
+
+	static void sampled_blocks(int_vector<> &&bits, int_vector<> &&ones, samples &in_bits, samples &in_ones)
+	{
+		in_bits = sampled(std::move(bits));
+		in_ones = sampled(std::move(ones));
+	}
+
+	template<class t_samples>
+	static uint64_t serialize_blocks(t_samples const &bits, t_samples const &ones, std::ostream &out, structure_tree_node *v)
+	{
+		uint64_t written_bytes = bits.serialize(out, v, "idx_bits");
+		return written_bytes + ones.serialize(out, v, "idx_ones");
+	}
+
+	template<class t_samples>
+	static void load_blocks(t_samples &bits, t_samples &ones, std::istream &in)
+	{
+		bits.load(in);
+		ones.load(in);
+	}
+};
+
+/* Two level counters, the bits and the 1 bits before each block sharing lines */
+struct fixed_samples
+{
+	typedef counters samples;
+	static uint64_t constexpr LAYOUT = 2;
+
+	static samples sampled(int_vector<> &&v)
+	{
+		return counters(v);
+	}
+
+	static void sampled_blocks(int_vector<> &&bits, int_vector<> &&ones, samples &in_bits, samples &in_ones)
+	{
+		counters::interleave(bits, ones, in_bits, in_ones);
+	}
+
+	static uint64_t serialize_blocks(samples const &bits, samples const &, std::ostream &out, structure_tree_node *v)
+	{
+		return bits.serialize(out, v, "idx_blocks");
+	}
+
+	static void load_blocks(samples &bits, samples &ones, std::istream &in)
+	{
+		bits.load(in);
+		if (bits.columns() == 2)
+			ones = bits.column(1);
+		else
+			in.setstate(std::ios::failbit);
+	}
+};
+
+
+/*
+ * Storage
+ *
+ * Container types a vector keeps its words and block samples in, picked
+ * by its vector_type: int_vector<32>, aligned_words, huge_words or
+ * mapped_words, which views a file written by serialize(). Words are
+ * always scanned through uint32_t pointers. Encoded words come from the
+ * builder in an int_vector<32> and are adopt()ed into the container;
+ * samples are computed in an int_vector<> and turned into theirs by a
+ * sample policy, compact unless vector_type is wrapped in fixed_counters.
+ * Any other vector_type, such as an int_vector<> of another width, keeps
+ * its words in an int_vector<32> as vectors always did. Words serialize
+ * alike in every container, so a file may be loaded or mapped with any
+ * vector_type whose sample policy wrote it, and with no other.
+ */
+template<class vector_type, class = void>
+struct storage : compact_samples
+{
+	typedef int_vector<32> words;
+	static bool constexpr mapped = false;
+
+	static words adopt(int_vector<32> &&seq, uint64_t const size)
+	{
+		seq.resize(size);
+		return std::move(seq);
+	}
+};
+
+/* Containers scanned through uint32_t pointers hold the words themselves */
+template<class vector_type>
+struct storage<vector_type, typename std::enable_if<std::is_same<decltype(std::declval<vector_type const &>().begin()), uint32_t const *>::value>::type>
+	: compact_samples
+{
+	typedef vector_type words;
+	static bool constexpr mapped = false;
+
+	static words adopt(int_vector<32> &&seq, uint64_t const size)
+	{
+		return words(seq.begin(), seq.begin() + size);
+	}
+};
+
+template<>
+struct storage<int_vector<32>> : compact_samples
+{
+	typedef int_vector<32> words;
+	static bool constexpr mapped = false;
+
+	static words adopt(int_vector<32> &&seq, uint64_t const size)
+	{
+		seq.resize(size);
+		return std::move(seq);
+	}
+};
+
+/* Words as vector_type keeps them, block samples in two level counters */
+template<class vector_type = int_vector<32>>
+struct fixed_counters
+{
+	static_assert(not storage<vector_type>::mapped, "fixed_counters: mapped vectors view their samples as serialized");
+
+	typedef typename storage<vector_type>::words::iterator       iterator;
+	typedef typename storage<vector_type>::words::const_iterator const_iterator;
+	typedef typename storage<vector_type>::words::size_type      size_type;
+};
+
+template<class vector_type>
+struct storage<fixed_counters<vector_type>> : fixed_samples
+{
+	typedef typename storage<vector_type>::words words;
+	static bool constexpr mapped = false;
+
+	static words adopt(int_vector<32> &&seq, uint64_t const size)
+	{
+		return storage<vector_type>::adopt(std::move(seq), size);
+	}
+};
+
+/* Views of the words and samples, which are written back as compact ones */
+template<>
+struct storage<mapped_words> : compact_samples
+{
+	typedef mapped_words   words;
+	typedef mapped_samples samples;
+	static bool constexpr mapped = true;
+};
+
+} /* namespace s18 */
+} /* namespace sdsl */
+
+#endif
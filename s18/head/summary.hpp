@@ -0,0 +1,133 @@
+/*
+ * summary: Per word summaries for S18 compressed bitvectors
+ * Copyright (C) 2019  Manuel Weitzman
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDED_SDSL_S18_SUMMARY
+#define INCLUDED_SDSL_S18_SUMMARY
+
+#include <cstdint>
+#include <string>
+
+#include <sdsl/int_vector.hpp>
+#include <sdsl/util.hpp>
+
+#include "decoder.hpp"
+
+
+namespace sdsl
+{
+namespace s18
+{
+
+/*
+ * Word summaries
+ *
+ * Tell query scans how many 1 bits a word encodes and how many bits it
+ * spans, so words before the target are skipped without decoding them.
+ * Ones always come from the header; summaries differ in where spans come
+ * from. skip_bits() and skip_ones() skip words from `first` on, updating
+ * the running totals they are given.
+ */
+
+/* Spans are summed from the word itself, no extra space */
+class no_summary
+{
+	public:
+		void build(uint32_t const *, uint64_t) {}
+
+		uint64_t ones(uint64_t, uint32_t const w) const
+		{
+			return decoder::ones(w);
+		}
+
+		uint64_t span(uint64_t, uint32_t const w) const
+		{
+			return decoder::span(w);
+		}
+
+		uint64_t skip_bits(uint32_t const *words, uint64_t, uint64_t n, uint64_t target, uint64_t &accum, uint64_t &ones) const
+		{
+			return decoder::skip_bits(words, nullptr, n, target, accum, ones);
+		}
+
+		uint64_t skip_ones(uint32_t const *words, uint64_t, uint64_t n, uint64_t &counter, uint64_t &accum) const
+		{
+			return decoder::skip_ones(words, nullptr, n, counter, accum);
+		}
+
+		uint64_t serialize(std::ostream &, structure_tree_node * = nullptr, std::string = "") const
+		{
+			return 0;
+		}
+
+		void load(std::istream &) {}
+};
+
+/* One byte per word holding its span, 0 when it does not fit */
+class byte_summary
+{
+	private:
+		int_vector<8> spans;
+
+	public:
+		byte_summary(void)
+			: spans()
+		{}
+
+		void build(uint32_t const *words, uint64_t n)
+		{
+			spans = int_vector<8>(n, 0);
+			for (uint64_t i = 0; i < n; i++) {
+				uint64_t const s = decoder::span(words[i]);
+				spans[i] = s <= 0xFF ? static_cast<uint8_t>(s) : 0;
+			}
+		}
+
+		uint64_t ones(uint64_t, uint32_t const w) const
+		{
+			return decoder::ones(w);
+		}
+
+		uint64_t span(uint64_t const i, uint32_t const w) const
+		{
+			uint64_t const s = spans[i];
+			return s ? s : decoder::span(w);
+		}
+
+		uint64_t skip_bits(uint32_t const *words, uint64_t first, uint64_t n, uint64_t target, uint64_t &accum, uint64_t &ones) const
+		{
+			return decoder::skip_bits(words, spans.begin() + first, n, target, accum, ones);
+		}
+
+		uint64_t skip_ones(uint32_t const *words, uint64_t first, uint64_t n, uint64_t &counter, uint64_t &accum) const
+		{
+			return decoder::skip_ones(words, spans.begin() + first, n, counter, accum);
+		}
+
+		uint64_t serialize(std::ostream &out, structure_tree_node *v = nullptr, std::string name = "") const
+		{
+			return spans.serialize(out, v, name);
+		}
+
+		void load(std::istream &in)
+		{
+			spans.load(in);
+		}
+};
+
+} /* namespace s18 */
+} /* namespace sdsl */
+
+#endif
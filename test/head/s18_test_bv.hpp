@@ -0,0 +1,50 @@
+/*
+ * s18_test_bv: Bit vectors shared by the S18 compressed bitvector tests
+ * Copyright (C) 2019  Manuel Weitzman
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDED_S18_TEST_BV
+#define INCLUDED_S18_TEST_BV
+
+#include <cstdint>
+#include <random>
+#include <sdsl/int_vector.hpp>
+#include "s18_vector.hpp"
+
+
+/* Template arguments of the vectors and supports tested with word summaries */
+#define S18_SUMMARIZED 64, sdsl::int_vector<32>, sdsl::s18::byte_summary
+
+/* Densities every query is checked at, from empty to nearly full */
+static double constexpr DENSITIES[] = {0., .001, .05, .5, .95};
+
+/* Bit vector with 1 bits at density p and some runs of 1s */
+inline sdsl::bit_vector runs_bv(uint64_t size, double p, std::default_random_engine &g)
+{
+	std::bernoulli_distribution one(p);
+	std::bernoulli_distribution run(.002);
+	std::uniform_int_distribution<uint64_t> len(1, 300);
+
+	sdsl::bit_vector bv(size, 0);
+	for (uint64_t i = 0; i < size; i++) {
+		if (run(g))
+			for (uint64_t j = len(g); j and i < size; j--, i++)
+				bv[i] = 1;
+		if (i < size)
+			bv[i] = one(g);
+	}
+	return bv;
+}
+
+#endif
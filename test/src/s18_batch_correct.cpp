@@ -0,0 +1,216 @@
+/*
+ * s18::vector: Batched queries over S18 compressed bitvectors
+ * Copyright (C) 2019  Manuel Weitzman
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+#include <sdsl/int_vector.hpp>
+#include "s18_vector.hpp"
+#include "s18_test_bv.hpp"
+#include "catch.hpp"
+
+
+/* Sorted keys, the same keys shuffled, and sorted keys with repeats */
+static std::vector<std::vector<uint64_t>> batch_keys(uint64_t lo, uint64_t hi, std::default_random_engine &g)
+{
+	std::vector<std::vector<uint64_t>> keys(3);
+	if (lo > hi) return keys;
+
+	std::uniform_int_distribution<uint64_t> key(lo, hi);
+	for (uint64_t i = 0; i < 2000; i++)
+		keys[0].push_back(key(g));
+	std::sort(keys[0].begin(), keys[0].end());
+	keys[1] = keys[0];
+	std::shuffle(keys[1].begin(), keys[1].end(), g);
+	for (uint64_t i = lo; i <= std::min(hi, lo + 3000); i++)
+		keys[2].insert(keys[2].end(), 1 + i % 3, i);
+	return keys;
+}
+
+
+TEMPLATE_TEST_CASE_SIG("Batched queries match single queries", "[batch]", ((uint16_t B), B), (8), (64), (256))
+{
+	std::default_random_engine g;
+
+	for (double p : DENSITIES) {
+		for (uint64_t it = 0; it < 5; it++) {
+			sdsl::bit_vector bv = runs_bv(20000, p, g);
+			sdsl::s18::vector<B> s18(bv);
+			sdsl::s18::rank_support<1, B> rs(s18);
+			sdsl::s18::rank_support<0, B> rs0(s18);
+			sdsl::s18::select_support<1, B> ss(s18);
+
+			for (std::vector<uint64_t> const &keys : batch_keys(0, bv.size() - 1, g)) {
+				std::vector<uint64_t> out(keys.size());
+				s18.access_batch(keys.data(), keys.size(), out.data());
+				for (uint64_t i = 0; i < keys.size(); i++)
+					REQUIRE(out[i] == bv[keys[i]]);
+
+				rs.rank_batch(keys.data(), keys.size(), out.data());
+				for (uint64_t i = 0; i < keys.size(); i++)
+					REQUIRE(out[i] == rs(keys[i]));
+
+				rs0.rank_batch(keys.data(), keys.size(), out.data());
+				for (uint64_t i = 0; i < keys.size(); i++)
+					REQUIRE(out[i] == rs0(keys[i]));
+			}
+
+			for (std::vector<uint64_t> const &keys : batch_keys(1, s18.ones(), g)) {
+				std::vector<uint64_t> out(keys.size());
+				ss.select_batch(keys.data(), keys.size(), out.data());
+				for (uint64_t i = 0; i < keys.size(); i++)
+					REQUIRE(out[i] == ss(keys[i]));
+			}
+		}
+	}
+}
+
+TEST_CASE("Batched queries work with word summaries", "[batch]")
+{
+	std::default_random_engine g;
+	sdsl::bit_vector bv = runs_bv(50000, .1, g);
+	sdsl::s18::vector<S18_SUMMARIZED> s18(bv);
+	sdsl::s18::rank_support<1, S18_SUMMARIZED> rs(s18);
+	sdsl::s18::select_support<1, S18_SUMMARIZED> ss(s18);
+
+	std::vector<uint64_t> keys(bv.size() + 1);
+	std::iota(keys.begin(), keys.end(), 0);
+	std::vector<uint64_t> out(keys.size());
+	rs.rank_batch(keys.data(), keys.size(), out.data());
+	for (uint64_t i = 0, ones = 0; i <= bv.size(); i++) {
+		REQUIRE(out[i] == ones);
+		if (i < bv.size()) ones += bv[i];
+	}
+
+	keys.resize(s18.ones());
+	std::iota(keys.begin(), keys.end(), 1);
+	ss.select_batch(keys.data(), keys.size(), out.data());
+	for (uint64_t i = 0, k = 0; i < bv.size(); i++)
+		if (bv[i]) REQUIRE(out[k++] == i + 1);
+}
+
+TEMPLATE_TEST_CASE_SIG("Interleaved queries match single queries", "[batch]", ((uint16_t B), B), (8), (64), (256))
+{
+	std::default_random_engine g;
+
+	for (double p : DENSITIES) {
+		sdsl::bit_vector bv = runs_bv(30000, p, g);
+		sdsl::s18::vector<B> s18(bv);
+		sdsl::s18::rank_support<1, B> rs(s18);
+		sdsl::s18::rank_support<0, B> rs0(s18);
+		sdsl::s18::select_support<1, B> ss(s18);
+
+		for (uint64_t n : {0, 1, 5, 3000}) {
+			std::vector<uint64_t> keys(n);
+			std::uniform_int_distribution<uint64_t> bit(0, bv.size() - 1);
+			for (uint64_t &k : keys) k = bit(g);
+
+			std::vector<uint64_t> out(n);
+			s18.access_interleaved(keys.data(), n, out.data());
+			for (uint64_t i = 0; i < n; i++)
+				REQUIRE(out[i] == bv[keys[i]]);
+
+			rs.template rank_interleaved<1>(keys.data(), n, out.data());
+			for (uint64_t i = 0; i < n; i++)
+				REQUIRE(out[i] == rs(keys[i]));
+
+			rs.rank_interleaved(keys.data(), n, out.data());
+			for (uint64_t i = 0; i < n; i++)
+				REQUIRE(out[i] == rs(keys[i]));
+
+			rs0.template rank_interleaved<4>(keys.data(), n, out.data());
+			for (uint64_t i = 0; i < n; i++)
+				REQUIRE(out[i] == rs0(keys[i]));
+
+			if (s18.ones() == 0) continue;
+			std::uniform_int_distribution<uint64_t> one(1, s18.ones());
+			for (uint64_t &k : keys) k = one(g);
+			ss.select_interleaved(keys.data(), n, out.data());
+			for (uint64_t i = 0; i < n; i++)
+				REQUIRE(out[i] == ss(keys[i]));
+		}
+	}
+}
+
+TEMPLATE_TEST_CASE_SIG("Cursors match single queries", "[batch]", ((uint16_t B), B), (8), (64), (256))
+{
+	std::default_random_engine g;
+
+	for (double p : DENSITIES) {
+		sdsl::bit_vector bv = runs_bv(20000, p, g);
+		sdsl::s18::vector<B> s18(bv);
+		sdsl::s18::rank_support<1, B> rs(s18);
+		sdsl::s18::select_support<1, B> ss(s18);
+		sdsl::s18::successor_support<B> succ(s18);
+
+		/* Every key in order, then mixed queries moving mostly forward */
+		sdsl::s18::cursor<B> c(s18);
+		for (uint64_t i = 0; i <= bv.size(); i++)
+			REQUIRE(c.rank(i) == rs(i));
+		c.reset();
+		for (uint64_t i = 0; i < bv.size(); i++) {
+			REQUIRE(c.access(i) == bv[i]);
+			REQUIRE(c.successor(i) == succ(i));
+		}
+		c.reset();
+		for (uint64_t k = 1; k <= s18.ones(); k++)
+			REQUIRE(c.select(k) == ss(k));
+
+		std::uniform_int_distribution<uint64_t> step(0, 400);
+		std::bernoulli_distribution back(.05);
+		for (uint64_t key = 0, it = 0; it < 3000; it++) {
+			key = back(g) ? key / 2 : std::min<uint64_t>(key + step(g), bv.size() - 1);
+			REQUIRE(c.rank(key) == rs(key));
+			REQUIRE(c.access(key) == bv[key]);
+			REQUIRE(c.successor(key) == succ(key));
+			uint64_t const k = rs(key);
+			if (k) REQUIRE(c.select(k) == ss(k));
+		}
+	}
+}
+
+TEMPLATE_TEST_CASE_SIG("Select on 0 bits matches a linear scan", "[batch]", ((uint16_t B), B), (8), (64), (256))
+{
+	std::default_random_engine g;
+
+	for (double p : {0., .001, .05, .5, .95, .999}) {
+		for (uint64_t it = 0; it < 5; it++) {
+			sdsl::bit_vector bv = runs_bv(20000, p, g);
+			for (uint64_t i = bv.size() - 50; it % 2 and i < bv.size(); i++)
+				bv[i] = 0;
+			sdsl::s18::vector<B> s18(bv);
+			sdsl::s18::select_support<0, B> ss(s18);
+
+			std::vector<uint64_t> keys;
+			std::vector<uint64_t> expected;
+			for (uint64_t i = 0; i < bv.size(); i++) {
+				if (bv[i]) continue;
+				keys.push_back(keys.size() + 1);
+				expected.push_back(i + 1);
+			}
+
+			for (uint64_t k = 0; k < keys.size(); k++)
+				REQUIRE(ss(keys[k]) == expected[k]);
+
+			std::vector<uint64_t> out(keys.size());
+			ss.select_batch(keys.data(), keys.size(), out.data());
+			REQUIRE(out == expected);
+			ss.select_interleaved(keys.data(), keys.size(), out.data());
+			REQUIRE(out == expected);
+		}
+	}
+}
@@ -0,0 +1,327 @@
+/*
+ * s18::builder: Streaming construction of S18 compressed bitvectors
+ * Copyright (C) 2019  Manuel Weitzman
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <sdsl/int_vector.hpp>
+#include "s18_vector.hpp"
+#include "catch.hpp"
+
+
+/* Random bit vector with runs of 1s, so every case shows up */
+static sdsl::bit_vector random_bv(uint64_t size, double p, std::default_random_engine &g)
+{
+	std::bernoulli_distribution one(p);
+	std::bernoulli_distribution run(.01);
+	std::uniform_int_distribution<uint64_t> len(1, 100);
+
+	sdsl::bit_vector bv(size, 0);
+	for (uint64_t i = 0; i < size; i++) {
+		if (run(g))
+			for (uint64_t j = len(g); j and i < size; j--, i++)
+				bv[i] = 1;
+		if (i < size)
+			bv[i] = one(g);
+	}
+	return bv;
+}
+
+/* Whether gaps [i, j) fit in the chunks of one word, min_bits or more wide */
+static bool chunks_fit(std::vector<uint32_t> const &gaps, uint64_t i, uint64_t j, uint64_t min_bits)
+{
+	uint64_t width = min_bits;
+	for (uint64_t k = i; k < j; k++)
+		width = std::max(width, sdsl::s18::word::chunk_bits(gaps[k]));
+	return (j - i) * width <= 28;
+}
+
+/* Fewest words holding gaps, trying every split */
+static uint64_t fewest_words(std::vector<uint32_t> const &gaps)
+{
+	uint64_t const n = gaps.size();
+	std::vector<uint64_t> words(n + 1, n + 1);
+	words[0] = 0;
+	for (uint64_t i = 0; i < n; i++) {
+		uint64_t ones = 0;
+		while (i + ones < n and gaps[i + ones] == 1)
+			ones++;
+		for (uint64_t j = i + 1; j <= n and j - i <= std::max<uint64_t>(ones, 28) + 28; j++) {
+			bool const run = j - i <= ones;
+			bool const lead = ones >= 28 and j - i > 28 and chunks_fit(gaps, i + 28, j, 2);
+			if (run or lead or chunks_fit(gaps, i, j, 1))
+				words[j] = std::min(words[j], words[i] + 1);
+		}
+	}
+	return words[n];
+}
+
+
+TEMPLATE_TEST_CASE_SIG("Built vectors match vectors compressed from bit vectors", "[builder]", ((uint16_t B), B), (8), (64), (256))
+{
+	std::default_random_engine g;
+
+	for (double p : {.01, .1, .5, .9}) {
+		for (uint64_t it = 0; it < 20; it++) {
+			sdsl::bit_vector bv = random_bv(5000, p, g);
+			std::vector<uint64_t> positions;
+			for (uint64_t i = 0; i < bv.size(); i++)
+				if (bv[i]) positions.push_back(i);
+			if (positions.empty()) continue;
+
+			sdsl::s18::vector<B> expected(bv);
+			sdsl::s18::builder<B> b(bv.size());
+			b.append(positions.begin(), positions.end());
+			sdsl::s18::vector<B> s18 = b.build();
+
+			REQUIRE(s18.size() == expected.size());
+			REQUIRE(s18.data().size() == expected.data().size());
+			for (uint64_t i = 0; i < s18.data().size(); i++)
+				REQUIRE(s18.data()[i] == expected.data()[i]);
+
+			sdsl::s18::rank_support<1, B> rs(s18);
+			sdsl::s18::select_support<1, B> ss(s18);
+			for (uint64_t i = 0, ones = 0; i < bv.size(); i++) {
+				REQUIRE(s18[i] == bv[i]);
+				REQUIRE(rs(i) == ones);
+				ones += bv[i];
+			}
+			for (uint64_t i = 0; i < positions.size(); i++)
+				REQUIRE(ss(i + 1) == positions[i] + 1);
+		}
+	}
+}
+
+TEST_CASE("Sparse vectors are built without their bit vector", "[builder]")
+{
+	std::default_random_engine g;
+	std::uniform_int_distribution<uint64_t> gap(1, (uint64_t(1) << 28) - 1);
+
+	std::vector<uint64_t> positions;
+	sdsl::s18::builder<> b;
+	for (uint64_t i = 0, pos = 0; i < 5000; i++) {
+		pos += gap(g);
+		positions.push_back(pos);
+		b.push_back(pos);
+	}
+	REQUIRE(b.ones() == positions.size());
+
+	sdsl::s18::vector<> s18 = b.build();
+	REQUIRE(s18.size() == positions.back() + 1);
+	REQUIRE(b.ones() == 0);
+
+	sdsl::s18::rank_support<> rs(s18);
+	sdsl::s18::select_support<> ss(s18);
+	for (uint64_t i = 0; i < positions.size(); i++) {
+		REQUIRE(ss(i + 1) == positions[i] + 1);
+		REQUIRE(rs(positions[i]) == i);
+		REQUIRE(rs(positions[i] + 1) == i + 1);
+		REQUIRE(s18[positions[i]] == 1);
+		REQUIRE(s18[positions[i] - 1] == 0);
+	}
+}
+
+TEST_CASE("Gaps and positions may be mixed", "[builder]")
+{
+	sdsl::s18::builder<8> b(100);
+	b.push_gap(1);
+	b.push_back(5);
+	b.push_gap(3);
+
+	sdsl::s18::vector<8> s18 = b.build();
+	sdsl::s18::rank_support<1, 8> rs(s18);
+	REQUIRE(s18.size() == 100);
+	REQUIRE(s18[0] == 1);
+	REQUIRE(s18[5] == 1);
+	REQUIRE(s18[8] == 1);
+	REQUIRE(rs(100) == 3);
+
+	/* Fixed width samples hold nothing past the last one, rank at size() must stay in them */
+	sdsl::s18::builder<8, sdsl::s18::fixed_counters<>> f(100);
+	f.push_gap(1);
+	f.push_back(5);
+	f.push_gap(3);
+
+	sdsl::s18::vector<8, sdsl::s18::fixed_counters<>> fixed = f.build();
+	sdsl::s18::rank_support<1, 8, sdsl::s18::fixed_counters<>> frs(fixed);
+	REQUIRE(fixed.size() == 100);
+	REQUIRE(fixed[0] == 1);
+	REQUIRE(fixed[5] == 1);
+	REQUIRE(fixed[8] == 1);
+	REQUIRE(frs(100) == 3);
+}
+
+TEST_CASE("Empty builders give empty vectors", "[builder]")
+{
+	sdsl::s18::builder<> b(1000);
+	sdsl::s18::vector<> s18 = b.build();
+	sdsl::s18::rank_support<> rs(s18);
+
+	REQUIRE(s18.size() == 1000);
+	for (uint64_t i = 0; i < s18.size(); i++) {
+		REQUIRE(s18[i] == 0);
+		REQUIRE(rs(i) == 0);
+	}
+}
+
+TEST_CASE("Invalid input is rejected", "[builder]")
+{
+	sdsl::s18::builder<> b(10);
+	b.push_back(3);
+	REQUIRE_THROWS_AS(b.push_back(3), std::invalid_argument);
+	REQUIRE_THROWS_AS(b.push_back(2), std::invalid_argument);
+	REQUIRE_THROWS_AS(b.push_gap(0), std::invalid_argument);
+	REQUIRE_THROWS_AS(b.push_gap(uint64_t(1) << 28), std::invalid_argument);
+
+	b.push_back(20);
+	REQUIRE_THROWS_AS(b.build(), std::invalid_argument);
+}
+
+TEST_CASE("Bit vectors are compressed through the builder", "[builder]")
+{
+	sdsl::bit_vector zeros(1000, 0);
+	sdsl::s18::vector<> empty(zeros);
+	REQUIRE(empty.size() == 1000);
+	REQUIRE(empty.data().size() == 0);
+	REQUIRE(empty[999] == 0);
+
+	sdsl::bit_vector far((uint64_t(1) << 28) + 1, 0);
+	far[uint64_t(1) << 28] = 1;
+	REQUIRE_THROWS_AS(sdsl::s18::vector<>(far), std::invalid_argument);
+}
+
+TEMPLATE_TEST_CASE_SIG("Parallel construction gives the serial encoding", "[builder]", ((uint16_t B), B), (8), (256))
+{
+	std::default_random_engine g;
+
+	for (double p : {.001, .05, .5, .99}) {
+		for (uint64_t it = 0; it < 10; it++) {
+			sdsl::bit_vector bv = random_bv(20000, p, g);
+			sdsl::s18::vector<B> expected(bv);
+
+			for (uint64_t threads : {2, 3, 8, 64}) {
+				sdsl::s18::vector<B> s18(bv, threads);
+				REQUIRE(s18.size() == expected.size());
+				REQUIRE(s18.data().size() == expected.data().size());
+				for (uint64_t i = 0; i < s18.data().size(); i++)
+					REQUIRE(s18.data()[i] == expected.data()[i]);
+
+				sdsl::s18::rank_support<1, B> rs(s18);
+				sdsl::s18::rank_support<1, B> ers(expected);
+				for (uint64_t i = 0; i <= bv.size(); i += 97)
+					REQUIRE(rs(i) == ers(i));
+			}
+		}
+	}
+
+	/* Runs of 1s spanning several segments */
+	sdsl::bit_vector run(100000, 1);
+	run[70000] = 0;
+	sdsl::s18::vector<B> expected(run);
+	sdsl::s18::vector<B> s18(run, 16);
+	REQUIRE(s18.data().size() == expected.data().size());
+	for (uint64_t i = 0; i < s18.data().size(); i++)
+		REQUIRE(s18.data()[i] == expected.data()[i]);
+}
+
+TEMPLATE_TEST_CASE_SIG("Optimal packing takes no more words than greedy packing", "[builder]", ((uint16_t B), B), (8), (256))
+{
+	std::default_random_engine g;
+	uint64_t greedy_words = 0;
+	uint64_t optimal_words = 0;
+
+	for (double p : {.01, .1, .5, .9, .99}) {
+		for (uint64_t it = 0; it < 10; it++) {
+			sdsl::bit_vector bv = random_bv(20000, p, g);
+			sdsl::s18::vector<B> greedy(bv);
+			sdsl::s18::vector<B> s18(bv, sdsl::s18::packing::optimal);
+			REQUIRE(s18.data().size() <= greedy.data().size());
+			greedy_words += greedy.data().size();
+			optimal_words += s18.data().size();
+
+			sdsl::s18::rank_support<1, B> rs(s18);
+			sdsl::s18::select_support<1, B> ss(s18);
+			for (uint64_t i = 0, ones = 0; i < bv.size(); i++) {
+				REQUIRE(s18[i] == bv[i]);
+				REQUIRE(rs(i) == ones);
+				ones += bv[i];
+				if (bv[i]) REQUIRE(ss(ones) == i + 1);
+			}
+		}
+	}
+	REQUIRE(optimal_words < greedy_words);
+
+	/* Greedy takes a 1 after the wide gap, losing the word with 28 leading 1s */
+	sdsl::s18::builder<B> b(0, sdsl::s18::packing::optimal);
+	sdsl::s18::builder<B> gb;
+	std::vector<uint32_t> gaps(29, 1);
+	gaps[0] = 1000;
+	gaps.insert(gaps.end(), {5, 5, 5, 5, 5});
+	for (uint32_t gap : gaps) {
+		b.push_gap(gap);
+		gb.push_gap(gap);
+	}
+	sdsl::s18::vector<B> s18 = b.build();
+	sdsl::s18::vector<B> greedy = gb.build();
+	REQUIRE(s18.data().size() < greedy.data().size());
+	REQUIRE(s18.size() == greedy.size());
+
+	/* Long runs of 1s */
+	sdsl::bit_vector run(300000, 1);
+	run[100] = 0;
+	run[250000] = 0;
+	sdsl::s18::vector<B> expected(run);
+	sdsl::s18::vector<B> dense(run, sdsl::s18::packing::optimal);
+	sdsl::s18::rank_support<1, B> rs(dense);
+	REQUIRE(dense.data().size() <= expected.data().size());
+	for (uint64_t i = 0, ones = 0; i < run.size(); i++) {
+		REQUIRE(dense[i] == run[i]);
+		REQUIRE(rs(i) == ones);
+		ones += run[i];
+	}
+}
+
+TEST_CASE("Optimal packing takes the fewest words", "[builder]")
+{
+	std::default_random_engine g;
+	std::uniform_int_distribution<uint32_t> run(0, 90);
+	std::uniform_int_distribution<uint32_t> small(2, 9);
+	std::uniform_int_distribution<uint32_t> count(1, 6);
+	std::bernoulli_distribution wide(.05);
+
+	/* Runs of 1s, often longer than 28, each followed by a few small gaps */
+	for (uint64_t it = 0; it < 3000; it++) {
+		std::vector<uint32_t> gaps;
+		while (gaps.size() < 400) {
+			gaps.insert(gaps.end(), run(g), 1);
+			for (uint32_t k = count(g); k; k--)
+				gaps.push_back(wide(g) ? 1000 : small(g));
+		}
+
+		sdsl::s18::builder<8> b(0, sdsl::s18::packing::optimal);
+		for (uint32_t gap : gaps)
+			b.push_gap(gap);
+		sdsl::s18::vector<8> s18 = b.build();
+		REQUIRE(s18.data().size() == fewest_words(gaps));
+
+		sdsl::s18::select_support<1, 8> ss(s18);
+		for (uint64_t i = 0, pos = 0; i < gaps.size(); i++) {
+			pos += gaps[i];
+			REQUIRE(ss(i + 1) == pos);
+		}
+	}
+}
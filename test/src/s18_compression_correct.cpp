@@ -184,6 +184,12 @@ TEMPLATE_TEST_CASE_SIG("All cases are compressed correctly", "[compression]", ((
 					for (uint64_t i = 0; i < av.size(); i++)
 						REQUIRE(ss(i + 1) == av[i]);
 				}
+				AND_THEN("It is decompressed correctly (using select0)")
+				{
+					sdsl::s18::select_support<0, B> ss(s18);
+					for (uint64_t i = 0, k = 0; i < bv.size(); i++)
+						if (not bv[i]) REQUIRE(ss(++k) == i + 1);
+				}
 			}
 		}
 }
@@ -244,6 +250,12 @@ TEMPLATE_TEST_CASE_SIG("100 sparse vectors are compressed correctly", "", ((uint
 				for (uint64_t i = 0; i < av.size(); i++)
 					REQUIRE(ss(i + 1) == av[i]);
 			}
+			AND_THEN("It is decompressed correctly (using select0)")
+			{
+				sdsl::s18::select_support<0, B> ss(s18);
+				for (uint64_t i = 0, k = 0; i < bv.size(); i++)
+					if (not bv[i]) REQUIRE(ss(++k) == i + 1);
+			}
 		}
 	}
 }
@@ -303,6 +315,12 @@ TEMPLATE_TEST_CASE_SIG("100 normal vectors are compressed correctly", "", ((uint
 				for (uint64_t i = 0; i < av.size(); i++)
 					REQUIRE(ss(i + 1) == av[i]);
 			}
+			AND_THEN("It is decompressed correctly (using select0)")
+			{
+				sdsl::s18::select_support<0, B> ss(s18);
+				for (uint64_t i = 0, k = 0; i < bv.size(); i++)
+					if (not bv[i]) REQUIRE(ss(++k) == i + 1);
+			}
 		}
 	}
 }
@@ -362,6 +380,55 @@ TEMPLATE_TEST_CASE_SIG("100 dense vectors are compressed correctly", "", ((uint1
 				for (uint64_t i = 0; i < av.size(); i++)
 					REQUIRE(ss(i + 1) == av[i]);
 			}
+			AND_THEN("It is decompressed correctly (using select0)")
+			{
+				sdsl::s18::select_support<0, B> ss(s18);
+				for (uint64_t i = 0, k = 0; i < bv.size(); i++)
+					if (not bv[i]) REQUIRE(ss(++k) == i + 1);
+			}
+		}
+	}
+}
+
+
+TEMPLATE_TEST_CASE_SIG("100 vectors with word summaries are compressed correctly", "", ((uint16_t B), B), (8), (64), (256), (1024))
+{
+	GIVEN("A bit vector")
+	{
+		sdsl::bit_vector bv = GENERATE(take(RANDOM_ITERATIONS, GeneratorWrapper<sdsl::bit_vector>(std::unique_ptr<IGenerator<sdsl::bit_vector>>(new Generator(4000, .05)))));
+		sdsl::int_vector<64> av(sdsl::util::cnt_one_bits(bv), 0);
+
+		for (uint64_t i = 0, j = 0; i < bv.size(); i++)
+			if (bv[i]) av[j++] = i + 1;
+
+		sdsl::int_vector<64> rv1 = bv_to_rank(bv, 1);
+
+		WHEN("It is compressed")
+		{
+			sdsl::s18::vector<B, sdsl::int_vector<32>, sdsl::s18::byte_summary> s18(bv);
+			THEN("It is decompressed correctly (using [indexed] access)")
+			{
+				for (uint64_t i = 0; i < bv.size(); i++)
+					REQUIRE(bv[i] == s18[i]);
+			}
+			AND_THEN("It is decompressed correctly (using rank1)")
+			{
+				sdsl::s18::rank_support<1, B, sdsl::int_vector<32>, sdsl::s18::byte_summary> rs(s18);
+				for (uint64_t i = 0; i < bv.size(); i++)
+					REQUIRE(rs(i) == rv1[i]);
+			}
+			AND_THEN("It is decompressed correctly (using select1)")
+			{
+				sdsl::s18::select_support<1, B, sdsl::int_vector<32>, sdsl::s18::byte_summary> ss(s18);
+				for (uint64_t i = 0; i < av.size(); i++)
+					REQUIRE(ss(i + 1) == av[i]);
+			}
+			AND_THEN("It is decompressed correctly (using select0)")
+			{
+				sdsl::s18::select_support<0, B, sdsl::int_vector<32>, sdsl::s18::byte_summary> ss(s18);
+				for (uint64_t i = 0, k = 0; i < bv.size(); i++)
+					if (not bv[i]) REQUIRE(ss(++k) == i + 1);
+			}
 		}
 	}
 }
@@ -0,0 +1,220 @@
+/*
+ * s18::decoder: Bulk decoding of S18 words into gap arrays
+ * Copyright (C) 2019  Manuel Weitzman
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <random>
+#include <string>
+#include <vector>
+#include "decoder.hpp"
+#include "catch.hpp"
+
+
+static uint32_t const decoder_cases[17] = {
+	CASE01, CASE02, CASE03, CASE04, CASE05, CASE06, CASE07, CASE08, CASE09,
+	CASE10, CASE11, CASE12, CASE13, CASE14, CASE15, CASE16, CASE17
+};
+static uint64_t const decoder_bits[17]   = {28,14, 9, 7, 4, 3, 2,28,14, 9, 7, 4, 3, 2, 5, 0, 5};
+static uint64_t const decoder_chunks[17] = { 1, 2, 3, 4, 7, 9,14, 1, 2, 3, 4, 7, 9,14, 5, 0, 5};
+
+
+/* Build a word of case C holding `used` random chunks, returns expected entries */
+std::vector<uint32_t> random_word(uint64_t C, uint64_t used, uint32_t &w, std::default_random_engine &g)
+{
+	std::vector<uint32_t> expected;
+	w = decoder_cases[C];
+
+	if (C == 15) {
+		std::uniform_int_distribution<uint32_t> run(1, MASK_BODY5);
+		uint32_t const len = run(g);
+		w |= len;
+		expected.push_back(sdsl::s18::decoder::RUN | len);
+		return expected;
+	}
+
+	if (7 <= C and C <= 14)
+		expected.push_back(sdsl::s18::decoder::RUN | 28);
+
+	uint64_t const bits = decoder_bits[C];
+	std::uniform_int_distribution<uint32_t> chunk(1, static_cast<uint32_t>((uint64_t(1) << bits) - 1));
+	for (uint64_t i = 0; i < used; i++) {
+		uint32_t const c = chunk(g);
+		w |= c << (bits * (decoder_chunks[C] - i - 1));
+		expected.push_back(c);
+	}
+
+	return expected;
+}
+
+
+TEST_CASE("Every case is decoded correctly", "[decoder]")
+{
+	std::default_random_engine g;
+
+	for (uint64_t C = 0; C < 17; C++)
+		DYNAMIC_SECTION("Decoding is correct for C" << std::to_string(C + 1))
+		{
+			for (uint64_t used = (C == 15 ? 0 : 1); used <= decoder_chunks[C]; used++) {
+				uint32_t w = 0;
+				std::vector<uint32_t> expected = random_word(C, used, w, g);
+
+				uint32_t out[sdsl::s18::decoder::MAX_WORD_GAPS + sdsl::s18::decoder::PADDING];
+				uint64_t len = sdsl::s18::decoder::decode(&w, 1, out);
+				REQUIRE(len == expected.size());
+				for (uint64_t i = 0; i < len; i++)
+					REQUIRE(out[i] == expected[i]);
+
+				len = sdsl::s18::decoder::decode_scalar(&w, 1, out);
+				REQUIRE(len == expected.size());
+				for (uint64_t i = 0; i < len; i++)
+					REQUIRE(out[i] == expected[i]);
+			}
+		}
+}
+
+TEST_CASE("Runs of mixed words are decoded contiguously", "[decoder]")
+{
+	std::default_random_engine g;
+	std::uniform_int_distribution<uint64_t> pick(0, 16);
+
+	for (uint64_t it = 0; it < 100; it++) {
+		std::vector<uint32_t> words;
+		std::vector<uint32_t> expected;
+
+		for (uint64_t i = 0; i < 256; i++) {
+			uint64_t const C = pick(g);
+			std::uniform_int_distribution<uint64_t> used(C == 15 ? 0 : 1, decoder_chunks[C]);
+			uint32_t w = 0;
+			std::vector<uint32_t> e = random_word(C, used(g), w, g);
+			words.push_back(w);
+			expected.insert(expected.end(), e.begin(), e.end());
+		}
+
+		for (sdsl::s18::decoder::kernel const *k : sdsl::s18::decoder::supported()) {
+			INFO("Kernel " << k->name);
+			std::vector<uint32_t> out(words.size() * sdsl::s18::decoder::MAX_WORD_GAPS + sdsl::s18::decoder::PADDING);
+			uint64_t const len = k->decode(words.data(), words.size(), out.data());
+			REQUIRE(len == expected.size());
+			for (uint64_t i = 0; i < len; i++)
+				REQUIRE(out[i] == expected[i]);
+		}
+	}
+}
+
+TEST_CASE("Ones and spans are computed without decoding", "[decoder]")
+{
+	std::default_random_engine g;
+
+	for (uint64_t C = 0; C < 17; C++)
+		DYNAMIC_SECTION("Summaries are correct for C" << std::to_string(C + 1))
+		{
+			for (uint64_t used = (C == 15 ? 0 : 1); used <= decoder_chunks[C]; used++) {
+				uint32_t w = 0;
+				std::vector<uint32_t> expected = random_word(C, used, w, g);
+
+				uint64_t ones = 0, span = 0;
+				for (uint32_t const e : expected) {
+					uint64_t const len = e & sdsl::s18::decoder::RUN ? e ^ sdsl::s18::decoder::RUN : 1;
+					ones += len;
+					span += e & sdsl::s18::decoder::RUN ? len : e;
+				}
+
+				REQUIRE(sdsl::s18::decoder::ones(w) == ones);
+				REQUIRE(sdsl::s18::decoder::span(w) == span);
+			}
+		}
+}
+
+TEST_CASE("Chunk prefix sums are computed without decoding", "[decoder]")
+{
+	std::default_random_engine g;
+
+	for (uint64_t C = 0; C < 17; C++) {
+		if (C == 15) continue; /* C16 has no chunks */
+
+		DYNAMIC_SECTION("Prefix sums are correct for C" << std::to_string(C + 1))
+		{
+			for (uint64_t used = 1; used <= decoder_chunks[C]; used++) {
+				uint32_t w = 0;
+				std::vector<uint32_t> expected = random_word(C, used, w, g);
+				if (7 <= C and C <= 14)
+					expected.erase(expected.begin());
+
+				uint64_t sum = 0;
+				REQUIRE(sdsl::s18::decoder::chunk_sum(w, 0) == 0);
+				for (uint64_t k = 0; k < used; k++) {
+					uint64_t reached = 0;
+					REQUIRE(sdsl::s18::decoder::first_reaching(w, sum + 1, reached) == k + 1);
+					sum += expected[k];
+					REQUIRE(reached == sum);
+					REQUIRE(sdsl::s18::decoder::chunk_sum(w, k + 1) == sum);
+					REQUIRE(sdsl::s18::decoder::first_reaching(w, sum, reached) == k + 1);
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("Every supported kernel skips words alike", "[decoder]")
+{
+	std::default_random_engine g;
+	std::uniform_int_distribution<uint64_t> pick(0, 16);
+
+	REQUIRE(sdsl::s18::decoder::supported().back()->name == std::string("scalar"));
+	REQUIRE(sdsl::s18::decoder::supported().front() == &sdsl::s18::decoder::active());
+
+	for (uint64_t it = 0; it < 100; it++) {
+		std::vector<uint32_t> words;
+		for (uint64_t i = 0; i < 64; i++) {
+			uint64_t const C = pick(g);
+			std::uniform_int_distribution<uint64_t> used(C == 15 ? 0 : 1, decoder_chunks[C]);
+			uint32_t w = 0;
+			random_word(C, used(g), w, g);
+			words.push_back(w);
+		}
+
+		/* Stop within the last word */
+		uint64_t bits = 0, ones = 0;
+		for (uint32_t const w : words) {
+			bits += sdsl::s18::decoder::span(w);
+			ones += sdsl::s18::decoder::ones(w);
+		}
+		uint64_t const last_bits = sdsl::s18::decoder::span(words.back());
+		uint64_t const last_ones = sdsl::s18::decoder::ones(words.back());
+
+		/* Spans as kept by byte_summary */
+		std::vector<uint8_t> spans;
+		for (uint32_t const w : words) {
+			uint64_t const s = sdsl::s18::decoder::span(w);
+			spans.push_back(s <= 0xFF ? static_cast<uint8_t>(s) : 0);
+		}
+
+		uint8_t const *const sources[2] = {nullptr, spans.data()};
+
+		for (sdsl::s18::decoder::kernel const *k : sdsl::s18::decoder::supported())
+			for (uint8_t const *sp : sources) {
+				INFO("Kernel " << k->name << (sp ? " with spans" : ""));
+				uint64_t accum = 0, one_cnt = 0;
+				REQUIRE(k->skip_bits(words.data(), sp, words.size(), bits - last_bits + 1, accum, one_cnt) == words.size() - 1);
+				REQUIRE(accum == bits - last_bits);
+				REQUIRE(one_cnt == ones - last_ones);
+
+				uint64_t counter = ones - 1;
+				accum = 0;
+				REQUIRE(k->skip_ones(words.data(), sp, words.size(), counter, accum) == words.size() - 1);
+				REQUIRE(accum == bits - last_bits);
+				REQUIRE(counter == last_ones - 1);
+			}
+	}
+}
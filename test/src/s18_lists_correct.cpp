@@ -0,0 +1,123 @@
+/*
+ * s18::vector: List operations over S18 compressed bitvectors
+ * Copyright (C) 2019  Manuel Weitzman
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <vector>
+#include <sdsl/int_vector.hpp>
+#include "s18_vector.hpp"
+#include "s18_test_bv.hpp"
+#include "catch.hpp"
+
+
+TEMPLATE_TEST_CASE_SIG("Intersections match a linear merge", "[lists]", ((uint16_t B), B), (8), (64), (256))
+{
+	std::default_random_engine g;
+	std::uniform_int_distribution<uint64_t> size(1, 20000);
+	double const density[] = {0., .0005, .01, .1, .5, .95};
+
+	for (double p : density) {
+		for (double q : density) {
+			sdsl::bit_vector x = runs_bv(size(g), p, g);
+			sdsl::bit_vector y = runs_bv(size(g), q, g);
+			sdsl::s18::vector<B> a(x);
+			sdsl::s18::vector<B> b(y);
+
+			std::vector<uint64_t> expected;
+			for (uint64_t i = 0; i < std::min(x.size(), y.size()); i++)
+				if (x[i] and y[i]) expected.push_back(i);
+
+			std::vector<uint64_t> got;
+			sdsl::s18::intersect(a, b, std::back_inserter(got));
+			REQUIRE(got == expected);
+			REQUIRE(sdsl::s18::intersect_count(a, b) == expected.size());
+			REQUIRE(sdsl::s18::intersect_count(b, a) == expected.size());
+			REQUIRE(sdsl::s18::intersect_count(a, a) == a.ones());
+		}
+	}
+}
+
+TEST_CASE("Intersections work with word summaries", "[lists]")
+{
+	std::default_random_engine g;
+	sdsl::bit_vector x = runs_bv(50000, .002, g);
+	sdsl::bit_vector y = runs_bv(50000, .3, g);
+	sdsl::s18::vector<S18_SUMMARIZED> a(x);
+	sdsl::s18::vector<S18_SUMMARIZED> b(y);
+
+	std::vector<uint64_t> expected;
+	for (uint64_t i = 0; i < x.size(); i++)
+		if (x[i] and y[i]) expected.push_back(i);
+
+	std::vector<uint64_t> got;
+	sdsl::s18::intersect(a, b, std::back_inserter(got));
+	REQUIRE(got == expected);
+	REQUIRE(sdsl::s18::intersect_count(b, a) == expected.size());
+}
+
+TEMPLATE_TEST_CASE_SIG("Unions match the union of the bit vectors", "[lists]", ((uint16_t B), B), (8), (64), (256))
+{
+	std::default_random_engine g;
+	std::uniform_int_distribution<uint64_t> size(0, 20000);
+	std::uniform_int_distribution<uint64_t> density(0, 5);
+	double const p[] = {0., .0005, .01, .1, .5, .95};
+
+	for (uint64_t k : {1, 2, 3, 7, 20}) {
+		for (uint64_t it = 0; it < 5; it++) {
+			std::vector<sdsl::bit_vector> bvs;
+			std::vector<sdsl::s18::vector<B>> lists;
+			for (uint64_t i = 0; i < k; i++) {
+				bvs.push_back(runs_bv(size(g), p[density(g)], g));
+				lists.emplace_back(bvs.back());
+			}
+			std::vector<sdsl::s18::vector<B> const *> inputs;
+			uint64_t n = 0;
+			for (uint64_t i = 0; i < k; i++) {
+				inputs.push_back(&lists[i]);
+				n = std::max(n, bvs[i].size());
+			}
+
+			sdsl::bit_vector expected(n, 0);
+			for (sdsl::bit_vector const &bv : bvs)
+				for (uint64_t i = 0; i < bv.size(); i++)
+					expected[i] = expected[i] | bv[i];
+			sdsl::s18::vector<B> reference(expected);
+
+			sdsl::s18::vector<B> s18 = sdsl::s18::unite(inputs);
+			REQUIRE(s18.size() == reference.size());
+			REQUIRE(s18.ones() == reference.ones());
+			REQUIRE(s18.data().size() == reference.data().size());
+			for (uint64_t i = 0; i < s18.data().size(); i++)
+				REQUIRE(s18.data()[i] == reference.data()[i]);
+
+			sdsl::s18::rank_support<1, B> rs(s18);
+			for (uint64_t i = 0, ones = 0; i < n; i++) {
+				REQUIRE(s18[i] == expected[i]);
+				REQUIRE(rs(i) == ones);
+				ones += expected[i];
+			}
+		}
+	}
+
+	sdsl::bit_vector x(100, 0);
+	sdsl::bit_vector y(300, 0);
+	x[3] = y[3] = y[299] = 1;
+	sdsl::s18::vector<B> both = sdsl::s18::unite(sdsl::s18::vector<B>(x), sdsl::s18::vector<B>(y));
+	REQUIRE(both.size() == 300);
+	REQUIRE(both.ones() == 2);
+	REQUIRE(sdsl::s18::unite(std::vector<sdsl::s18::vector<B> const *>()).size() == 0);
+}
@@ -0,0 +1,154 @@
+/*
+ * s18::vector: Navigation over the 1 bits of S18 compressed bitvectors
+ * Copyright (C) 2019  Manuel Weitzman
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <vector>
+#include <sdsl/int_vector.hpp>
+#include "s18_vector.hpp"
+#include "s18_test_bv.hpp"
+#include "catch.hpp"
+
+
+TEMPLATE_TEST_CASE_SIG("Successor and predecessor match a linear scan", "[navigation]", ((uint16_t B), B), (8), (64), (256))
+{
+	std::default_random_engine g;
+
+	for (double p : DENSITIES) {
+		for (uint64_t it = 0; it < 10; it++) {
+			sdsl::bit_vector bv = runs_bv(6000, p, g);
+			sdsl::s18::vector<B> s18(bv);
+			sdsl::s18::successor_support<B> succ(s18);
+			sdsl::s18::predecessor_support<B> pred(s18);
+
+			std::vector<uint64_t> next(bv.size() + 1, bv.size());
+			for (uint64_t i = bv.size(); i-- > 0;)
+				next[i] = bv[i] ? i : next[i + 1];
+
+			for (uint64_t i = 0, last = bv.size(); i < bv.size(); i++) {
+				if (bv[i]) last = i;
+				REQUIRE(succ(i) == next[i]);
+				REQUIRE(pred(i) == last);
+			}
+			REQUIRE(succ(bv.size()) == bv.size());
+			REQUIRE(pred(bv.size() + 10) == pred(bv.size() - 1));
+		}
+	}
+}
+
+TEST_CASE("Successor and predecessor work with word summaries", "[navigation]")
+{
+	std::default_random_engine g;
+	sdsl::bit_vector bv = runs_bv(20000, .1, g);
+	sdsl::s18::vector<S18_SUMMARIZED> s18(bv);
+	sdsl::s18::successor_support<S18_SUMMARIZED> succ(s18);
+	sdsl::s18::predecessor_support<S18_SUMMARIZED> pred(s18);
+
+	uint64_t last = bv.size();
+	for (uint64_t i = 0; i < bv.size(); i++) {
+		if (bv[i]) last = i;
+		REQUIRE(pred(i) == last);
+		if (bv[i]) REQUIRE(succ(i) == i);
+		else REQUIRE(succ(i) > i);
+	}
+}
+
+TEMPLATE_TEST_CASE_SIG("Iterating over 1 bits visits every position", "[navigation]", ((uint16_t B), B), (8), (64), (256))
+{
+	std::default_random_engine g;
+
+	for (double p : DENSITIES) {
+		for (uint64_t it = 0; it < 10; it++) {
+			sdsl::bit_vector bv = runs_bv(6000, p, g);
+			sdsl::s18::vector<B> s18(bv);
+
+			std::vector<uint64_t> positions;
+			for (uint64_t i = 0; i < bv.size(); i++)
+				if (bv[i]) positions.push_back(i);
+
+			std::vector<uint64_t> walked(s18.begin_ones(), s18.end_ones());
+			REQUIRE(walked == positions);
+			REQUIRE(static_cast<uint64_t>(std::distance(s18.begin_ones(), s18.end_ones())) == positions.size());
+
+			/* Skipping forward lands on the successor */
+			sdsl::s18::successor_support<B> succ(s18);
+			std::uniform_int_distribution<uint64_t> step(1, 200);
+			auto one = s18.begin_ones();
+			for (uint64_t target = 0; one != s18.end_ones(); target += step(g)) {
+				one.skip_to(target);
+				REQUIRE(*one == succ(target));
+			}
+			REQUIRE(*one == bv.size());
+
+			/* Skipping from a fresh iterator, far ahead */
+			for (uint64_t target = 0; target < bv.size(); target += 777) {
+				auto far = s18.begin_ones();
+				far.skip_to(target);
+				REQUIRE(*far == succ(target));
+				if (far != s18.end_ones()) {
+					++far;
+					REQUIRE(*far == succ(succ(target) + 1));
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("Iterators work with standard algorithms", "[navigation]")
+{
+	sdsl::bit_vector bv(1000, 0);
+	for (uint64_t i = 0; i < bv.size(); i += 7) bv[i] = 1;
+	sdsl::s18::vector<8> s18(bv);
+
+	REQUIRE(std::find(s18.begin_ones(), s18.end_ones(), 700) != s18.end_ones());
+	REQUIRE(std::find(s18.begin_ones(), s18.end_ones(), 701) == s18.end_ones());
+	REQUIRE(std::accumulate(s18.begin_ones(), s18.end_ones(), uint64_t(0)) == 7 * (142 * 143 / 2));
+}
+
+TEMPLATE_TEST_CASE_SIG("Ranges decode every 1 bit within them", "[navigation]", ((uint16_t B), B), (8), (64), (256))
+{
+	std::default_random_engine g;
+
+	for (double p : DENSITIES) {
+		for (uint64_t it = 0; it < 5; it++) {
+			sdsl::bit_vector bv = runs_bv(6000, p, g);
+			sdsl::s18::vector<B> s18(bv);
+			std::uniform_int_distribution<uint64_t> bound(0, bv.size() + 10);
+
+			for (uint64_t q = 0; q < 200; q++) {
+				uint64_t a = bound(g);
+				uint64_t b = bound(g);
+				if (q % 10 == 0) a = 0;
+				if (q % 10 == 1) b = bv.size();
+
+				std::vector<uint64_t> expected;
+				for (uint64_t i = a; i < std::min<uint64_t>(b, bv.size()); i++)
+					if (bv[i]) expected.push_back(i);
+
+				std::vector<uint64_t> got;
+				s18.decode_range(a, b, std::back_inserter(got));
+				REQUIRE(got == expected);
+
+				std::vector<uint64_t> buffer(expected.size() + 1, 0);
+				REQUIRE(s18.decode_range(a, b, buffer.data()) == expected.size());
+				buffer.pop_back();
+				REQUIRE(buffer == expected);
+			}
+		}
+	}
+}
@@ -0,0 +1,528 @@
+/*
+ * s18::vector: Serializing, loading and mapping S18 compressed bitvectors
+ * Copyright (C) 2019  Manuel Weitzman
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <sdsl/int_vector.hpp>
+#include "s18_vector.hpp"
+#include "s18_test_bv.hpp"
+#include "catch.hpp"
+
+
+#define STORAGE_FILE "s18_storage_correct.tmp"
+#define STORAGE_SEGMENT ("/s18_storage_correct." + std::to_string(getpid()))
+
+/* Every query on s18 against bv */
+template<uint16_t B, class vector_type, class summary_type>
+static void require_same_queries(sdsl::s18::vector<B, vector_type, summary_type> &s18, sdsl::bit_vector const &bv)
+{
+	sdsl::s18::rank_support<1, B, vector_type, summary_type> rs(s18);
+	sdsl::s18::rank_support<0, B, vector_type, summary_type> rs0(s18);
+	sdsl::s18::select_support<1, B, vector_type, summary_type> ss(s18);
+	sdsl::s18::select_support<0, B, vector_type, summary_type> ss0(s18);
+	sdsl::s18::successor_support<B, vector_type, summary_type> succ(s18);
+
+	REQUIRE(s18.size() == bv.size());
+	uint64_t ones = 0;
+	uint64_t next = bv.size();
+	for (uint64_t i = bv.size(); i-- > 0;) {
+		if (bv[i]) next = i;
+		if (i % 7 == 0) REQUIRE(succ(i) == next);
+	}
+	for (uint64_t i = 0; i < bv.size(); i++) {
+		REQUIRE(s18[i] == bv[i]);
+		REQUIRE(rs(i) == ones);
+		REQUIRE(rs0(i) == i - ones);
+		if (bv[i]) REQUIRE(ss(++ones) == i + 1);
+		else REQUIRE(ss0(i + 1 - ones) == i + 1);
+	}
+	REQUIRE(s18.ones() == ones);
+
+	std::vector<uint64_t> walked(s18.begin_ones(), s18.end_ones());
+	REQUIRE(walked.size() == ones);
+}
+
+
+TEMPLATE_TEST_CASE_SIG("Loaded vectors match the serialized ones", "[storage]", ((uint16_t B), B), (8), (64), (256))
+{
+	std::default_random_engine g;
+
+	for (double p : DENSITIES) {
+		sdsl::bit_vector bv = runs_bv(20000, p, g);
+		sdsl::s18::vector<B> s18(bv);
+
+		std::stringstream stream;
+		uint64_t const written = s18.serialize(stream);
+		REQUIRE(written == sdsl::size_in_bytes(s18));
+
+		sdsl::s18::vector<B> loaded;
+		loaded.load(stream);
+		REQUIRE(stream.good());
+		REQUIRE(sdsl::size_in_bytes(loaded) == written);
+		REQUIRE(loaded.data() == s18.data());
+		require_same_queries(loaded, bv);
+	}
+}
+
+TEMPLATE_TEST_CASE_SIG("Every storage policy holds the same words", "[storage]", ((uint16_t B), B), (8), (64), (256))
+{
+	std::default_random_engine g;
+
+	for (double p : DENSITIES) {
+		sdsl::bit_vector bv = runs_bv(20000, p, g);
+		sdsl::s18::vector<B> s18(bv);
+		sdsl::s18::vector<B, sdsl::s18::aligned_words> aligned(bv);
+		sdsl::s18::vector<B, sdsl::s18::huge_words> huge(bv);
+
+		REQUIRE(reinterpret_cast<uintptr_t>(aligned.data().data()) % 64 == 0);
+		REQUIRE(aligned.data().size() == s18.data().size());
+		REQUIRE(std::equal(aligned.data().begin(), aligned.data().end(), s18.data().begin()));
+		require_same_queries(aligned, bv);
+		require_same_queries(huge, bv);
+
+		/* Every policy reads what any other one wrote */
+		std::stringstream stream;
+		aligned.serialize(stream);
+		sdsl::s18::vector<B> loaded;
+		loaded.load(stream);
+		REQUIRE(loaded.data() == s18.data());
+		stream.clear();
+		stream.seekg(0);
+		sdsl::s18::vector<B, sdsl::s18::huge_words> huge_loaded;
+		huge_loaded.load(stream);
+		REQUIRE(huge_loaded.data() == huge.data());
+
+		sdsl::s18::vector<B, sdsl::s18::aligned_words> copy(aligned);
+		REQUIRE(copy.data() == aligned.data());
+		REQUIRE(copy.data().data() != aligned.data().data());
+	}
+}
+
+TEST_CASE("Other int_vectors keep their words in an int_vector<32>", "[storage]")
+{
+	std::default_random_engine g;
+	sdsl::bit_vector bv = runs_bv(20000, .05, g);
+	sdsl::s18::vector<64> s18(bv);
+	sdsl::s18::vector<64, sdsl::int_vector<>> dynamic(bv);
+	sdsl::s18::vector<64, sdsl::int_vector<64>> wide(bv);
+
+	REQUIRE(dynamic.data() == s18.data());
+	REQUIRE(wide.data() == s18.data());
+	require_same_queries(dynamic, bv);
+	require_same_queries(wide, bv);
+}
+
+TEST_CASE("Huge page buffers are aligned to their pages", "[storage]")
+{
+	std::default_random_engine g;
+	sdsl::bit_vector bv = runs_bv(uint64_t(1) << 24, .5, g);
+	sdsl::s18::vector<64, sdsl::s18::huge_words> huge(bv);
+
+	REQUIRE(huge.data().size() * 4 >= sdsl::s18::huge_pages::PAGE);
+	REQUIRE(reinterpret_cast<uintptr_t>(huge.data().data()) % sdsl::s18::huge_pages::PAGE == 0);
+	sdsl::s18::rank_support<1, 64, sdsl::s18::huge_words> rs(huge);
+	for (uint64_t i = 0, ones = 0; i < bv.size(); i += 97) {
+		REQUIRE(rs(i) == ones);
+		for (uint64_t j = i; j < std::min<uint64_t>(i + 97, bv.size()); j++)
+			ones += bv[j];
+	}
+}
+
+TEMPLATE_TEST_CASE_SIG("Mapped vectors match the serialized ones", "[storage]", ((uint16_t B), B), (8), (64), (256))
+{
+	std::default_random_engine g;
+
+	for (double p : DENSITIES) {
+		for (uint64_t size : {1, 777, 20000}) {
+			sdsl::bit_vector bv = runs_bv(size, p, g);
+			sdsl::s18::vector<B> s18(bv);
+			{
+				std::ofstream out(STORAGE_FILE, std::ios::binary);
+				s18.serialize(out);
+			}
+
+			sdsl::s18::mapped_vector<B> mapped(STORAGE_FILE);
+			REQUIRE(mapped.data().size() == s18.data().size());
+			for (uint64_t i = 0; i < s18.data().size(); i++)
+				REQUIRE(mapped.data()[i] == s18.data()[i]);
+			require_same_queries(mapped, bv);
+
+			/* Copies share the mapping, which outlives the original */
+			sdsl::s18::mapped_vector<B> *first = new sdsl::s18::mapped_vector<B>(STORAGE_FILE);
+			sdsl::s18::mapped_vector<B> copy(*first);
+			delete first;
+			require_same_queries(copy, bv);
+
+			/* Serialized again, a mapped vector writes the same bytes */
+			std::stringstream original;
+			std::stringstream again;
+			s18.serialize(original);
+			copy.serialize(again);
+			REQUIRE(again.str() == original.str());
+
+			sdsl::s18::vector<B> loaded(STORAGE_FILE);
+			REQUIRE(loaded.data() == s18.data());
+		}
+	}
+	std::remove(STORAGE_FILE);
+}
+
+TEST_CASE("Mapped vectors work with word summaries", "[storage]")
+{
+	std::default_random_engine g;
+	sdsl::bit_vector bv = runs_bv(50000, .1, g);
+	sdsl::s18::vector<S18_SUMMARIZED> s18(bv);
+	{
+		std::ofstream out(STORAGE_FILE, std::ios::binary);
+		s18.serialize(out);
+	}
+
+	sdsl::s18::mapped_vector<64, sdsl::s18::byte_summary> mapped(STORAGE_FILE);
+	require_same_queries(mapped, bv);
+	std::remove(STORAGE_FILE);
+}
+
+TEST_CASE("Mapping a truncated or missing file throws", "[storage]")
+{
+	std::default_random_engine g;
+	sdsl::bit_vector bv = runs_bv(20000, .1, g);
+	sdsl::s18::vector<64> s18(bv);
+	std::stringstream stream;
+	s18.serialize(stream);
+	std::string const bytes = stream.str();
+
+	for (uint64_t cut : {0, 5, 60, 1000}) {
+		{
+			std::ofstream out(STORAGE_FILE, std::ios::binary);
+			out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - cut * (bytes.size() / 1000)));
+		}
+		if (cut) {
+			REQUIRE_THROWS_AS(sdsl::s18::mapped_vector<64>(STORAGE_FILE), std::invalid_argument);
+			REQUIRE_THROWS_AS(sdsl::s18::vector<64>(STORAGE_FILE), std::invalid_argument);
+		} else {
+			REQUIRE_NOTHROW(sdsl::s18::mapped_vector<64>(STORAGE_FILE));
+		}
+	}
+	std::remove(STORAGE_FILE);
+	REQUIRE_THROWS_AS(sdsl::s18::mapped_vector<64>(STORAGE_FILE), std::system_error);
+}
+
+TEMPLATE_TEST_CASE_SIG("Published vectors are queried from other processes", "[storage]", ((uint16_t B), B), (8), (256))
+{
+	std::default_random_engine g;
+	std::string const name = STORAGE_SEGMENT;
+
+	for (double p : {0., .01, .5}) {
+		sdsl::bit_vector bv = runs_bv(30000, p, g);
+		sdsl::s18::vector<B> s18(bv);
+		sdsl::s18::rank_support<1, B> rs(s18);
+		sdsl::s18::select_support<1, B> ss(s18);
+		sdsl::s18::publish(s18, name);
+		REQUIRE_THROWS_AS(sdsl::s18::publish(s18, name), std::system_error);
+
+		/* Each worker answers a share of the queries and exits with 0 when all match */
+		uint64_t const workers = 4;
+		std::vector<pid_t> pids;
+		for (uint64_t w = 0; w < workers; w++) {
+			pid_t const pid = fork();
+			REQUIRE(pid >= 0);
+			if (pid)
+				pids.push_back(pid);
+			else {
+				bool ok = true;
+				try {
+					sdsl::s18::mapped_vector<B> shared = sdsl::s18::attach<B>(name);
+					sdsl::s18::rank_support<1, B, sdsl::s18::mapped_words> srs(shared);
+					sdsl::s18::select_support<1, B, sdsl::s18::mapped_words> sss(shared);
+					for (uint64_t i = w; i < bv.size(); i += workers)
+						ok = ok and shared[i] == bv[i] and srs(i) == rs(i);
+					for (uint64_t k = w + 1; k <= s18.ones(); k += workers)
+						ok = ok and sss(k) == ss(k);
+				} catch (...) {
+					ok = false;
+				}
+				_exit(ok ? 0 : 1);
+			}
+		}
+
+		for (pid_t const pid : pids) {
+			int status = 0;
+			REQUIRE(waitpid(pid, &status, 0) == pid);
+			REQUIRE(WIFEXITED(status));
+			REQUIRE(WEXITSTATUS(status) == 0);
+		}
+
+		/* Attached views outlive the name */
+		sdsl::s18::mapped_vector<B> attached = sdsl::s18::attach<B>(name);
+		sdsl::s18::unpublish(name);
+		REQUIRE_THROWS_AS(sdsl::s18::attach<B>(name), std::system_error);
+		require_same_queries(attached, bv);
+	}
+}
+
+TEST_CASE("Attaching checks the published layout", "[storage]")
+{
+	std::default_random_engine g;
+	std::string const name = STORAGE_SEGMENT;
+	sdsl::s18::vector<64> s18(runs_bv(20000, .1, g));
+	sdsl::s18::publish(s18, name);
+
+	REQUIRE_THROWS_AS(sdsl::s18::attach<128>(name), std::invalid_argument);
+	REQUIRE_THROWS_AS((sdsl::s18::attach<64, sdsl::s18::byte_summary>(name)), std::invalid_argument);
+	REQUIRE(sdsl::s18::attach<64>(name).ones() == s18.ones());
+	sdsl::s18::unpublish(name);
+	REQUIRE_THROWS_AS(sdsl::s18::unpublish(name), std::system_error);
+
+	sdsl::s18::vector<S18_SUMMARIZED> summarized(runs_bv(20000, .1, g));
+	sdsl::s18::publish(summarized, name);
+	sdsl::s18::mapped_vector<64, sdsl::s18::byte_summary> attached = sdsl::s18::attach<64, sdsl::s18::byte_summary>(name);
+	sdsl::s18::unpublish(name);
+	REQUIRE(attached.ones() == summarized.ones());
+}
+
+TEST_CASE("Attaching rejects vectors published with fixed width counters", "[storage]")
+{
+	std::default_random_engine g;
+	std::string const name = STORAGE_SEGMENT;
+	sdsl::s18::vector<64, sdsl::s18::fixed_counters<>> s18(runs_bv(200000, .1, g));
+	sdsl::s18::publish(s18, name);
+
+	REQUIRE_THROWS_AS(sdsl::s18::attach<64>(name), std::invalid_argument);
+	sdsl::s18::unpublish(name);
+}
+
+TEMPLATE_TEST_CASE_SIG("Blocked vectors answer like the vector they lay out", "[storage]", ((uint16_t B), B), (8), (12), (64), (256))
+{
+	std::default_random_engine g;
+
+	for (double p : DENSITIES) {
+		for (uint64_t size : {1, 777, 20000}) {
+			sdsl::bit_vector bv = runs_bv(size, p, g);
+			sdsl::s18::vector<B> s18(bv);
+			sdsl::s18::blocked_vector<B> blocked(s18);
+			sdsl::s18::rank_support<1, B> rs(s18);
+			sdsl::s18::select_support<1, B> ss(s18);
+
+			REQUIRE(blocked.size() == s18.size());
+			REQUIRE(blocked.ones() == s18.ones());
+			REQUIRE(reinterpret_cast<uintptr_t>(blocked.data().data()) % 64 == 0);
+			for (uint64_t i = 0; i < bv.size(); i++) {
+				REQUIRE(blocked[i] == bv[i]);
+				REQUIRE(blocked.rank(i) == rs(i));
+			}
+			REQUIRE(blocked.rank(bv.size()) == s18.ones());
+			for (uint64_t k = 1; k <= s18.ones(); k++)
+				REQUIRE(blocked.select(k) == ss(k));
+		}
+	}
+}
+
+TEMPLATE_TEST_CASE_SIG("Blocked vectors load what they serialized", "[storage]", ((uint16_t B), B), (8), (12), (256))
+{
+	std::default_random_engine g;
+
+	for (double p : DENSITIES) {
+		sdsl::bit_vector bv = runs_bv(20000, p, g);
+		sdsl::s18::blocked_vector<B> blocked(bv);
+		{
+			std::ofstream out(STORAGE_FILE, std::ios::binary);
+			REQUIRE(blocked.serialize(out) == sdsl::size_in_bytes(blocked));
+		}
+
+		sdsl::s18::blocked_vector<B> loaded(STORAGE_FILE);
+		REQUIRE(sdsl::size_in_bytes(loaded) == sdsl::size_in_bytes(blocked));
+		REQUIRE(loaded.data() == blocked.data());
+		for (uint64_t i = 0, ones = 0; i < bv.size(); i++) {
+			REQUIRE(loaded[i] == bv[i]);
+			REQUIRE(loaded.rank(i) == ones);
+			if (bv[i]) REQUIRE(loaded.select(++ones) == i + 1);
+		}
+	}
+
+	{
+		std::ofstream out(STORAGE_FILE, std::ios::binary);
+		out.write("S18", 3);
+	}
+	REQUIRE_THROWS_AS(sdsl::s18::blocked_vector<B>(STORAGE_FILE), std::invalid_argument);
+	std::remove(STORAGE_FILE);
+	REQUIRE_THROWS_AS(sdsl::s18::blocked_vector<B>(STORAGE_FILE), std::invalid_argument);
+}
+
+TEST_CASE("Blocked vectors work with word summaries", "[storage]")
+{
+	std::default_random_engine g;
+	sdsl::bit_vector bv = runs_bv(50000, .1, g);
+	sdsl::s18::blocked_vector<64, sdsl::s18::byte_summary> blocked(bv);
+
+	for (uint64_t i = 0, ones = 0; i < bv.size(); i++) {
+		REQUIRE(blocked[i] == bv[i]);
+		REQUIRE(blocked.rank(i) == ones);
+		if (bv[i]) REQUIRE(blocked.select(++ones) == i + 1);
+	}
+}
+
+TEST_CASE("Two level counters hold every value at any width", "[storage]")
+{
+	std::default_random_engine g;
+
+	for (uint64_t step : {uint64_t(1), uint64_t(1) << 14, uint64_t(1) << 28, uint64_t(1) << 40}) {
+		std::uniform_int_distribution<uint64_t> gap(0, step);
+		for (uint64_t n : {0, 1, 15, 16, 17, 1000}) {
+			sdsl::int_vector<> v(n, 0);
+			for (uint64_t i = 1; i < n; i++)
+				v[i] = v[i - 1] + gap(g);
+
+			sdsl::s18::counters c(v);
+			REQUIRE(c.size() == n);
+			for (uint64_t i = 0; i < n; i++)
+				REQUIRE(c[i] == v[i]);
+
+			std::stringstream stream;
+			uint64_t const written = c.serialize(stream);
+			REQUIRE(written == stream.str().size());
+			sdsl::s18::counters loaded;
+			loaded.load(stream);
+			REQUIRE(stream.good());
+			REQUIRE(loaded.size() == n);
+			for (uint64_t i = 0; i < n; i++)
+				REQUIRE(loaded[i] == v[i]);
+
+			/* Two columns sharing lines, written once */
+			sdsl::int_vector<> w(n, 0);
+			for (uint64_t i = 0; i < n; i++)
+				w[i] = v[i] / 2 + i;
+			sdsl::s18::counters a, b;
+			sdsl::s18::counters::interleave(v, w, a, b);
+			for (uint64_t i = 0; i < n; i++) {
+				REQUIRE(a[i] == v[i]);
+				REQUIRE(b[i] == w[i]);
+				REQUIRE(a.line(i) == b.line(i));
+			}
+			std::stringstream pair;
+			a.serialize(pair);
+			REQUIRE(b.serialize(pair) == 0);
+			loaded.load(pair);
+			REQUIRE(loaded.columns() == 2);
+			for (uint64_t i = 0; i < n; i++)
+				REQUIRE(loaded.column(1)[i] == w[i]);
+		}
+	}
+}
+
+TEMPLATE_TEST_CASE_SIG("Fixed width counters answer like compact samples", "[storage]", ((uint16_t B), B), (8), (64), (256))
+{
+	std::default_random_engine g;
+
+	for (double p : DENSITIES) {
+		sdsl::bit_vector bv = runs_bv(20000, p, g);
+		sdsl::s18::vector<B, sdsl::s18::fixed_counters<>> s18(bv);
+		sdsl::s18::vector<B, sdsl::s18::fixed_counters<sdsl::s18::aligned_words>> aligned(bv);
+		require_same_queries(s18, bv);
+		require_same_queries(aligned, bv);
+
+		std::vector<uint64_t> keys(bv.size());
+		for (uint64_t i = 0; i < bv.size(); i++)
+			keys[i] = (i * 7919) % bv.size();
+		std::vector<uint64_t> out(keys.size());
+		sdsl::s18::rank_support<1, B, sdsl::s18::fixed_counters<>> rs(s18);
+		rs.rank_interleaved(keys.data(), keys.size(), out.data());
+		for (uint64_t i = 0; i < keys.size(); i++)
+			REQUIRE(out[i] == rs(keys[i]));
+
+		std::stringstream stream;
+		REQUIRE(s18.serialize(stream) == sdsl::size_in_bytes(s18));
+		sdsl::s18::vector<B, sdsl::s18::fixed_counters<>> loaded;
+		loaded.load(stream);
+		REQUIRE(stream.good());
+		require_same_queries(loaded, bv);
+
+		sdsl::s18::blocked_vector<B> blocked(s18);
+		for (uint64_t i = 0; i < bv.size(); i++)
+			REQUIRE(blocked[i] == bv[i]);
+	}
+}
+
+TEST_CASE("Vectors only load and map files with their sample layout", "[storage]")
+{
+	std::default_random_engine g;
+	sdsl::bit_vector bv = runs_bv(200000, .1, g);
+	sdsl::s18::vector<64, sdsl::s18::fixed_counters<>> fixed(bv);
+	sdsl::s18::vector<64> compact(bv);
+
+	{
+		std::ofstream out(STORAGE_FILE, std::ios::binary);
+		fixed.serialize(out);
+	}
+	REQUIRE_THROWS_AS(sdsl::s18::vector<64>(STORAGE_FILE), std::invalid_argument);
+	REQUIRE_THROWS_AS(sdsl::s18::mapped_vector<64>(STORAGE_FILE), std::invalid_argument);
+	REQUIRE(sdsl::s18::vector<64, sdsl::s18::fixed_counters<>>(STORAGE_FILE).ones() == fixed.ones());
+
+	{
+		std::ofstream out(STORAGE_FILE, std::ios::binary);
+		compact.serialize(out);
+	}
+	REQUIRE_THROWS_AS((sdsl::s18::vector<64, sdsl::s18::fixed_counters<>>(STORAGE_FILE)), std::invalid_argument);
+	REQUIRE(sdsl::s18::mapped_vector<64>(STORAGE_FILE).ones() == compact.ones());
+	std::remove(STORAGE_FILE);
+
+	std::stringstream stream;
+	fixed.serialize(stream);
+	sdsl::s18::vector<64> loaded;
+	loaded.load(stream);
+	REQUIRE(stream.fail());
+}
+
+TEMPLATE_TEST_CASE_SIG("Fixed width counters answer at the ends of the vector", "[storage]", ((uint16_t B), B), (8), (64), (256))
+{
+	std::default_random_engine g;
+
+	/* 1 bits 2^20 apart take a word each, so B = 8 gives 16 l2 samples and size() / 16 is their divisor */
+	std::vector<sdsl::bit_vector> bvs(1, sdsl::bit_vector(uint64_t(120) << 20, 0));
+	for (uint64_t i = 1; i <= 120; i++)
+		bvs[0][(i << 20) - 1] = 1;
+	for (double p : {0., .001, .05, .5, .95, 1.})
+		for (uint64_t size : {1, 2, 100, 777, 20000})
+			bvs.push_back(runs_bv(size, p, g));
+
+	for (sdsl::bit_vector const &bv : bvs) {
+		uint64_t ones = 0;
+		uint64_t last = 0;
+		for (uint64_t i = 0; i < bv.size(); i++)
+			if (bv[i]) ones++, last = i + 1;
+
+		sdsl::s18::vector<B, sdsl::s18::fixed_counters<>> s18(bv);
+		sdsl::s18::rank_support<1, B, sdsl::s18::fixed_counters<>> rs(s18);
+		sdsl::s18::rank_support<0, B, sdsl::s18::fixed_counters<>> rs0(s18);
+		sdsl::s18::select_support<1, B, sdsl::s18::fixed_counters<>> ss(s18);
+		REQUIRE(rs(bv.size()) == ones);
+		REQUIRE(rs0(bv.size()) == bv.size() - ones);
+		if (ones) REQUIRE(ss(ones) == last);
+
+		uint64_t const key = bv.size();
+		uint64_t out = 0;
+		rs.rank_batch(&key, 1, &out);
+		REQUIRE(out == ones);
+		rs.rank_interleaved(&key, 1, &out);
+		REQUIRE(out == ones);
+	}
+}